@@ -0,0 +1,85 @@
+#ifndef __ALLOC_H_
+#define __ALLOC_H_
+
+#include <switch.h>
+
+// Heap allocation counter, to check the main loop doesn't allocate once warmed
+// up. newlib's malloc is slow and fragments the applet heap. With
+// ENABLE_ALLOC_COUNTER the Makefile links with --wrap for newlib's reentrant
+// allocators, which malloc, operator new and libc itself all end up in, and
+// every call is counted on its way through. Both go together: the wrappers
+// below are what --wrap links against, so include this from one translation
+// unit only.
+//
+// The driver allocates behind some GL and EGL calls every frame (sync objects,
+// swaps). Those are bracketed with allocPause/allocResume, which only affect
+// the calling thread, so the count is the app's own allocations.
+
+#ifdef ENABLE_ALLOC_COUNTER
+#include <reent.h>
+#include <atomic>
+
+static std::atomic<u32> s_alloc_count(0);
+static thread_local u32 s_alloc_paused = 0; // nesting depth on this thread
+
+static inline bool allocCounted() {
+    return s_alloc_paused == 0;
+}
+
+extern "C" {
+void* __real__malloc_r(struct _reent* r, size_t size);
+void* __real__calloc_r(struct _reent* r, size_t count, size_t size);
+void* __real__realloc_r(struct _reent* r, void* ptr, size_t size);
+void* __real__memalign_r(struct _reent* r, size_t align, size_t size);
+
+void* __wrap__malloc_r(struct _reent* r, size_t size) {
+    if (allocCounted())
+        s_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return __real__malloc_r(r, size);
+}
+
+void* __wrap__calloc_r(struct _reent* r, size_t count, size_t size) {
+    if (allocCounted())
+        s_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return __real__calloc_r(r, count, size);
+}
+
+void* __wrap__realloc_r(struct _reent* r, void* ptr, size_t size) {
+    if (allocCounted())
+        s_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return __real__realloc_r(r, ptr, size);
+}
+
+void* __wrap__memalign_r(struct _reent* r, size_t align, size_t size) {
+    if (allocCounted())
+        s_alloc_count.fetch_add(1, std::memory_order_relaxed);
+    return __real__memalign_r(r, align, size);
+}
+}
+
+// Allocations made so far, from any thread
+static inline u32 allocCount() {
+    return s_alloc_count.load(std::memory_order_relaxed);
+}
+
+// Leaves the calling thread's allocations uncounted until the matching allocResume
+static inline void allocPause() {
+    s_alloc_paused++;
+}
+
+static inline void allocResume() {
+    s_alloc_paused--;
+}
+#else
+static inline u32 allocCount() {
+    return 0;
+}
+
+static inline void allocPause() {
+}
+
+static inline void allocResume() {
+}
+#endif
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef __ARENA_H_
+#define __ARENA_H_
+
+#include <stddef.h>
+
+#include <switch.h>
+
+// Linear arena for transient data. Allocations bump an offset into a block set
+// aside up front and are only ever released together, by rewinding to an
+// earlier mark or by a reset. The heap is never touched, so running out shows
+// up as a null pointer and a failure count rather than growth.
+//
+// The frame arena belongs to the main thread and is reset at the start of
+// every frame. In the loop it holds the instance pass's segment list and the
+// profiler report's sort space; outside it serves startup work such as loading
+// program binaries, hence the size.
+
+#define ARENA_ALIGN 16
+#define FRAME_ARENA_SIZE 0x40000
+
+struct Arena {
+    u8* base;
+    size_t capacity;
+    size_t used;
+    size_t high_water;
+    u32 failed; // allocations that didn't fit
+};
+
+alignas(ARENA_ALIGN) static u8 s_frame_arena_memory[FRAME_ARENA_SIZE];
+static Arena s_frame_arena = { s_frame_arena_memory, FRAME_ARENA_SIZE, 0, 0, 0 };
+
+static void* arenaAlloc(Arena* arena, size_t size) {
+    size_t begin = (arena->used + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+    if (begin + size > arena->capacity) {
+        arena->failed++;
+        return nullptr;
+    }
+    arena->used = begin + size;
+    if (arena->used > arena->high_water)
+        arena->high_water = arena->used;
+    return arena->base + begin;
+}
+
+template <typename T>
+static inline T* arenaAllocArray(Arena* arena, size_t count) {
+    return (T*)arenaAlloc(arena, count * sizeof(T));
+}
+
+static inline size_t arenaMark(const Arena* arena) {
+    return arena->used;
+}
+
+static inline void arenaRewind(Arena* arena, size_t mark) {
+    arena->used = mark;
+}
+
+static inline void arenaReset(Arena* arena) {
+    arena->used = 0;
+}
+
+#endif
@@ -0,0 +1,147 @@
+#ifndef __BENCH_H_
+#define __BENCH_H_
+
+#include <stdio.h>
+#include <sys/stat.h>
+
+#include <switch.h>
+
+#include <config.h>
+#include <profiler.h>
+#include <framebuffer.h>
+#include <resolution.h>
+#include <perf.h>
+
+// Benchmark mode: replays a fixed input script instead of reading the pad,
+// advances the simulation clock by exactly 1/60 s per frame, and after the
+// warm-up plus the configured number of frames writes the lifetime profiler
+// totals and frame-time histograms to BENCH_RESULTS_PATH.
+
+#define BENCH_RESULTS_PATH CONFIG_DIR "/bench.csv"
+
+// Set by the Makefile, so results name the build that produced them
+#ifndef BUILD_VARIANT
+#define BUILD_VARIANT "unknown"
+#endif
+
+struct BenchStep {
+    int frames;
+    u64 buttons; // held for the whole step
+};
+
+// Looped for the whole run: rotation both ways, every color switch and a reset
+static const BenchStep s_bench_script[] = {
+    {  60, 0 },                                         // red reveal from black
+    { 120, HidNpadButton_Right },                       // move and spin right
+    {  90, HidNpadButton_Up },                          // blue reveal
+    { 120, HidNpadButton_Left | HidNpadButton_Down },   // spin left during the green reveal
+    {  60, HidNpadButton_Left },                        // back to red while spinning
+    {   1, HidNpadButton_Minus },                       // reset
+    {  60, HidNpadButton_Up },                          // blue reveal at rest
+    {  60, 0 },                                         // red reveal at rest
+};
+
+static struct {
+    const AppConfig* config;
+    int frame;       // frames rendered so far, warm-up included
+    int step;        // current entry of s_bench_script
+    int step_frame;  // frames spent in the current step
+    u64 prev_buttons;
+    u64 start_tick;
+} s_bench;
+
+static void benchStart(const AppConfig* config) {
+    s_bench.config = config;
+    s_bench.frame = 0;
+    s_bench.step = 0;
+    s_bench.step_frame = 0;
+    s_bench.prev_buttons = 0;
+    s_bench.start_tick = armGetSystemTick();
+    TRACE("benchmark: %d frames after %d warm-up frames, seed 0x%x", config->benchmark_frames, config->benchmark_warmup_frames, config->benchmark_seed);
+}
+
+// Scripted replacement for padGetButtons / padGetButtonsDown
+static void benchInput(u64* buttons, u64* keys_down) {
+    const int steps = sizeof(s_bench_script) / sizeof(s_bench_script[0]);
+    if (s_bench.step_frame >= s_bench_script[s_bench.step].frames) {
+        s_bench.step = (s_bench.step + 1) % steps;
+        s_bench.step_frame = 0;
+    }
+    s_bench.step_frame++;
+
+    *buttons = s_bench_script[s_bench.step].buttons;
+    *keys_down = *buttons & ~s_bench.prev_buttons;
+    s_bench.prev_buttons = *buttons;
+}
+
+// Fixed 60 Hz simulation clock, so the reveal progresses identically on every run
+static u64 benchFrameTick() {
+    return s_bench.start_tick + armGetSystemTickFreq() * s_bench.frame / 60;
+}
+
+// Call at the end of every frame; returns false once the run is complete
+static bool benchAdvance() {
+    s_bench.frame++;
+    if (s_bench.frame == s_bench.config->benchmark_warmup_frames)
+        profilerResetTotals();
+    return s_bench.frame < s_bench.config->benchmark_warmup_frames + s_bench.config->benchmark_frames;
+}
+
+static void benchWriteSummary(FILE* f, const char* name, const ProfileTotals* totals) {
+    if (totals->samples == 0)
+        return;
+    fprintf(f, "%s,%u,%.4f,%.4f,%.4f,%.4f\n", name, totals->samples, totals->min, totals->sum / totals->samples,
+            profileTotalsPercentile(totals, 0.99f), totals->max);
+}
+
+static bool benchWriteResults() {
+    mkdir(CONFIG_DIR, 0777);
+    FILE* f = fopen(BENCH_RESULTS_PATH, "w");
+    if (!f) {
+        TRACE("cannot open %s", BENCH_RESULTS_PATH);
+        return false;
+    }
+
+    fprintf(f, "# rsbsPLUS-nx benchmark, %s build, %d frames, seed 0x%x, framebuffer %s, perf %s, render scale %.2f (%dx%d), %u heap allocations\n",
+            BUILD_VARIANT, s_bench.config->benchmark_frames, s_bench.config->benchmark_seed, s_framebuffer_profiles[s_bench.config->framebuffer].name,
+            s_perf_profiles[s_bench.config->perf_profile].name, s_resolution.scale, s_resolution.render_width, s_resolution.render_height,
+            s_profiler.heap_allocations_total);
+    fprintf(f, "series,samples,min_ms,avg_ms,p99_ms,max_ms\n");
+    for (int zone = 0; zone < ProfileCpu_Count; zone++)
+        benchWriteSummary(f, s_profile_cpu_names[zone], &s_profiler.cpu[zone].totals);
+    for (int zone = 0; zone < ProfileGpu_Count; zone++)
+        benchWriteSummary(f, s_profile_gpu_names[zone], &s_profiler.gpu[zone].totals);
+    for (int core = 0; core < PROFILER_CORES; core++)
+        benchWriteSummary(f, s_profile_core_names[core], &s_profiler.cores[core].totals);
+
+    // Histograms side by side, one column per series, empty buckets skipped
+    fprintf(f, "\nbucket_ms");
+    for (int zone = 0; zone < ProfileCpu_Count; zone++)
+        fprintf(f, ",%s", s_profile_cpu_names[zone]);
+    for (int zone = 0; zone < ProfileGpu_Count; zone++)
+        fprintf(f, ",%s", s_profile_gpu_names[zone]);
+    fprintf(f, "\n");
+
+    for (int bucket = 0; bucket < PROFILER_HISTOGRAM_BUCKETS; bucket++) {
+        u32 any = 0;
+        for (int zone = 0; zone < ProfileCpu_Count; zone++)
+            any |= s_profiler.cpu[zone].totals.histogram[bucket];
+        for (int zone = 0; zone < ProfileGpu_Count; zone++)
+            any |= s_profiler.gpu[zone].totals.histogram[bucket];
+        if (!any)
+            continue;
+
+        fprintf(f, "%.1f", bucket * PROFILER_HISTOGRAM_BUCKET_MS);
+        for (int zone = 0; zone < ProfileCpu_Count; zone++)
+            fprintf(f, ",%u", s_profiler.cpu[zone].totals.histogram[bucket]);
+        for (int zone = 0; zone < ProfileGpu_Count; zone++)
+            fprintf(f, ",%u", s_profiler.gpu[zone].totals.histogram[bucket]);
+        fprintf(f, "\n");
+    }
+
+    fclose(f);
+    TRACE("results written to %s", BENCH_RESULTS_PATH);
+    return true;
+}
+
+#endif
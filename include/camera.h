@@ -0,0 +1,75 @@
+#ifndef __CAMERA_H_
+#define __CAMERA_H_
+
+#include <math.h>
+
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/mat4x4.hpp>
+#include <glm/vec3.hpp>
+
+// Fixed perspective camera looking down -Z at the origin. It sits at the
+// distance where the plane z = 0 spans y = -1..1, so scene coordinates line up
+// with the old projection-less clip space vertically while the horizontal
+// extent follows the real aspect ratio. The frustum planes are kept in world
+// space for culling bounding spheres.
+
+#define CAMERA_FOV_Y_DEGREES 45.0f
+#define CAMERA_NEAR 0.1f
+#define CAMERA_FAR 10.0f
+
+struct Camera {
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::mat4 view_projection;
+    glm::vec4 frustum[6]; // xyz: inward normal, w: distance, all normalized
+};
+
+static void cameraInit(Camera* camera, float aspect) {
+    float fov = glm::radians(CAMERA_FOV_Y_DEGREES);
+    float distance = 1.0f / tanf(fov * 0.5f);
+
+    camera->projection = glm::perspective(fov, aspect, CAMERA_NEAR, CAMERA_FAR);
+    camera->view = glm::lookAt(glm::vec3(0.0f, 0.0f, distance), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    camera->view_projection = camera->projection * camera->view;
+
+    // Gribb-Hartmann: every plane is the matrix's last row plus or minus another row
+    const glm::mat4& m = camera->view_projection;
+    for (int i = 0; i < 6; i++) {
+        int row = i / 2;
+        float sign = (i & 1) ? -1.0f : 1.0f;
+        glm::vec4 plane(m[0][3] + sign * m[0][row], m[1][3] + sign * m[1][row], m[2][3] + sign * m[2][row], m[3][3] + sign * m[3][row]);
+        camera->frustum[i] = plane * (1.0f / sqrtf(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z));
+    }
+}
+
+// The one matrix the vertex shader needs: projection * view * model
+static inline glm::mat4 cameraModelViewProjection(const Camera* camera, const glm::mat4& model) {
+    return camera->view_projection * model;
+}
+
+// Clip-space image of a world-space direction. Because a translation doesn't
+// change directions, an instance offset can be added after the shared MVP.
+static inline glm::vec4 cameraClipOffset(const Camera* camera, const glm::vec3& offset) {
+    return camera->view_projection * glm::vec4(offset, 0.0f);
+}
+
+// Whether a world-space sphere is at least partly inside the frustum
+static inline bool cameraSphereVisible(const Camera* camera, const glm::vec3& center, float radius) {
+    for (int i = 0; i < 6; i++) {
+        const glm::vec4& p = camera->frustum[i];
+        if (p.x * center.x + p.y * center.y + p.z * center.z + p.w < -radius)
+            return false;
+    }
+    return true;
+}
+
+// Approximate on-screen radius in pixels of a sphere at a world-space position
+static inline float cameraProjectedRadius(const Camera* camera, const glm::vec3& center, float radius, float viewport_height) {
+    float depth = -(camera->view * glm::vec4(center, 1.0f)).z;
+    if (depth < CAMERA_NEAR)
+        depth = CAMERA_NEAR;
+    return radius * camera->projection[1][1] / depth * viewport_height * 0.5f;
+}
+
+#endif
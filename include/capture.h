@@ -0,0 +1,301 @@
+#ifndef __CAPTURE_H_
+#define __CAPTURE_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <atomic>
+
+#include <switch.h>
+
+#include <config.h>
+
+// Frame capture for offline analysis: a window of frames is recorded into a
+// buffer in memory, one length-prefixed record per frame. Once the window is
+// complete a writer thread saves it to CAPTURE_PATH, so the render thread never
+// touches the card. The buffer and the thread are set up by captureInit,
+// outside the render loop, and only when captures are enabled; the buffer is
+// sized from the caller's bound on a record. What goes into a record is up to
+// the caller. Replay
+// loads the whole file and hands the records back in order. The format is tied
+// to the build that wrote it: the caller's record layout version is checked,
+// nothing is converted.
+// Only the main thread reports, from capturePoll. Reports go through TRACE and
+// the writer's file I/O is left out of allocCount, so include nxlink.h and
+// alloc.h first.
+
+#define CAPTURE_PATH CONFIG_DIR "/capture.bin"
+#define CAPTURE_MAGIC 0x50435352 // "RSCP"
+#define CAPTURE_MAX_FRAMES 4096
+// Lowest priority, on the core whose job worker is idle for most of a frame
+#define CAPTURE_WRITER_PRIORITY 0x3F
+#define CAPTURE_WRITER_CORE 2
+#define CAPTURE_WRITER_STACK_SIZE 0x4000
+
+enum CaptureWrite {
+    CaptureWrite_Idle,
+    CaptureWrite_Pending,    // handed to the writer, the buffer is its until done
+    CaptureWrite_Done,
+    CaptureWrite_OpenFailed,
+    CaptureWrite_WriteFailed,
+};
+
+struct CaptureFileHeader {
+    u32 magic;
+    u32 layout; // caller's record layout, e.g. a version mixed with struct sizes
+    u32 frame_count;
+    u32 size;   // bytes of records that follow
+};
+
+static struct {
+    u8* buffer; // allocated once, by captureInit or replayLoad
+    u32 capacity;
+    u32 size;
+    u32 layout;
+    u32 frames_left;
+    u32 frame_count;
+    u32 record_begin;
+    bool active;
+    bool overflow;
+
+    // Writer thread
+    Thread writer;
+    bool writer_started;
+    bool writer_running; // under the mutex
+    Mutex mutex;
+    CondVar wake;
+    std::atomic<int> write; // CaptureWrite
+
+    // Replay
+    u32 offsets[CAPTURE_MAX_FRAMES];
+    u32 read;       // into the current record
+    u32 read_end;
+} s_capture;
+
+static bool captureActive() {
+    return s_capture.active;
+}
+
+// Saves the finished window, the records right after the header
+static CaptureWrite captureWriteFile() {
+    mkdir(CONFIG_DIR, 0777);
+    FILE* f = fopen(CAPTURE_PATH, "wb");
+    if (!f)
+        return CaptureWrite_OpenFailed;
+    CaptureFileHeader header = { CAPTURE_MAGIC, s_capture.layout, s_capture.frame_count, s_capture.size };
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 && fwrite(s_capture.buffer, s_capture.size, 1, f) == 1;
+    fclose(f);
+    if (!ok) {
+        remove(CAPTURE_PATH);
+        return CaptureWrite_WriteFailed;
+    }
+    return CaptureWrite_Done;
+}
+
+static void captureWriterMain(void* arg) {
+    mutexLock(&s_capture.mutex);
+    for (;;) {
+        while (s_capture.writer_running && s_capture.write.load(std::memory_order_acquire) != CaptureWrite_Pending)
+            condvarWait(&s_capture.wake, &s_capture.mutex);
+        if (s_capture.write.load(std::memory_order_acquire) != CaptureWrite_Pending)
+            break;
+        mutexUnlock(&s_capture.mutex);
+
+        // newlib's FILE buffers are the writer's, not the render loop's
+        allocPause();
+        CaptureWrite result = captureWriteFile();
+        allocResume();
+        s_capture.write.store(result, std::memory_order_release);
+        mutexLock(&s_capture.mutex);
+    }
+    mutexUnlock(&s_capture.mutex);
+}
+
+// At startup, when captures are enabled: room for frames records of at most
+// record_size bytes. Without the thread, files are written inline.
+static void captureInit(u32 frames, u32 record_size) {
+    if (frames > CAPTURE_MAX_FRAMES)
+        frames = CAPTURE_MAX_FRAMES;
+    u64 capacity = (u64)frames * record_size;
+    if (capacity == 0 || capacity > UINT32_MAX || !(s_capture.buffer = (u8*)malloc(capacity))) {
+        TRACE("no memory for %u captured frames (%llu KiB)", frames, (unsigned long long)(capacity / 1024));
+        return;
+    }
+    s_capture.capacity = (u32)capacity;
+    mutexInit(&s_capture.mutex);
+    condvarInit(&s_capture.wake);
+    s_capture.writer_running = true;
+    if (R_FAILED(threadCreate(&s_capture.writer, captureWriterMain, nullptr, nullptr, CAPTURE_WRITER_STACK_SIZE,
+                              CAPTURE_WRITER_PRIORITY, CAPTURE_WRITER_CORE))) {
+        s_capture.writer_running = false;
+        TRACE("no capture writer, captures are written on the render thread");
+        return;
+    }
+    threadStart(&s_capture.writer);
+    s_capture.writer_started = true;
+}
+
+// Lets a pending write finish
+static void captureExit() {
+    if (!s_capture.writer_started)
+        return;
+    mutexLock(&s_capture.mutex);
+    s_capture.writer_running = false;
+    condvarWakeAll(&s_capture.wake);
+    mutexUnlock(&s_capture.mutex);
+    threadWaitForExit(&s_capture.writer);
+    threadClose(&s_capture.writer);
+    s_capture.writer_started = false;
+}
+
+// Once per frame on the main thread, reports a write the writer has finished
+static void capturePoll() {
+    int write = s_capture.write.load(std::memory_order_acquire);
+    if (write == CaptureWrite_Idle || write == CaptureWrite_Pending)
+        return;
+    if (write == CaptureWrite_Done)
+        TRACE("%u frames (%u KiB) written to %s", s_capture.frame_count, s_capture.size / 1024, CAPTURE_PATH);
+    else
+        TRACE("cannot %s %s", write == CaptureWrite_OpenFailed ? "open" : "write", CAPTURE_PATH);
+    s_capture.write.store(CaptureWrite_Idle, std::memory_order_relaxed);
+}
+
+// Records the next frames frames; false if a capture is running or still being written
+static bool captureStart(u32 frames, u32 layout) {
+    if (s_capture.active || frames == 0)
+        return false;
+    if (!s_capture.buffer) {
+        TRACE("captures are off, no buffer was set aside at startup");
+        return false;
+    }
+    capturePoll();
+    if (s_capture.write.load(std::memory_order_acquire) != CaptureWrite_Idle) {
+        TRACE("previous capture still being written");
+        return false;
+    }
+    s_capture.size = 0;
+    s_capture.layout = layout;
+    s_capture.frames_left = frames < CAPTURE_MAX_FRAMES ? frames : CAPTURE_MAX_FRAMES;
+    s_capture.frame_count = 0;
+    s_capture.active = true;
+    s_capture.overflow = false;
+    TRACE("capturing %u frames", s_capture.frames_left);
+    return true;
+}
+
+static void captureWrite(const void* data, u32 size) {
+    if (!s_capture.active || s_capture.overflow)
+        return;
+    if (s_capture.size + size > s_capture.capacity) {
+        s_capture.overflow = true;
+        return;
+    }
+    memcpy(s_capture.buffer + s_capture.size, data, size);
+    s_capture.size += size;
+}
+
+static void captureBeginFrame() {
+    s_capture.record_begin = s_capture.size;
+    u32 length = 0;
+    captureWrite(&length, sizeof(length));
+}
+
+// Hands the window to the writer thread, capturePoll reports the outcome
+static void captureFinish() {
+    s_capture.active = false;
+    if (s_capture.frame_count == 0)
+        return;
+
+    if (!s_capture.writer_started) {
+        s_capture.write.store(captureWriteFile(), std::memory_order_release);
+        return;
+    }
+    mutexLock(&s_capture.mutex);
+    s_capture.write.store(CaptureWrite_Pending, std::memory_order_release);
+    condvarWakeOne(&s_capture.wake);
+    mutexUnlock(&s_capture.mutex);
+}
+
+// Closes the frame's record; the capture is written out after the last one
+static void captureEndFrame() {
+    if (!s_capture.active)
+        return;
+    if (s_capture.overflow) {
+        // Drop the partial record, the frames before it are still good
+        s_capture.size = s_capture.record_begin;
+        TRACE("capture buffer full after %u frames", s_capture.frame_count);
+        captureFinish();
+        return;
+    }
+    u32 length = s_capture.size - s_capture.record_begin - sizeof(u32);
+    memcpy(s_capture.buffer + s_capture.record_begin, &length, sizeof(length));
+    s_capture.frame_count++;
+    if (--s_capture.frames_left == 0)
+        captureFinish();
+}
+
+// Loads CAPTURE_PATH for replay into a buffer of its size, false if it's
+// missing or from another build
+static bool replayLoad(u32 layout) {
+    FILE* f = fopen(CAPTURE_PATH, "rb");
+    if (!f) {
+        TRACE("no capture at %s", CAPTURE_PATH);
+        return false;
+    }
+    CaptureFileHeader header;
+    bool ok = fread(&header, sizeof(header), 1, f) == 1 && header.magic == CAPTURE_MAGIC && header.layout == layout &&
+              header.frame_count > 0 && header.frame_count <= CAPTURE_MAX_FRAMES && header.size > 0 &&
+              (s_capture.buffer || (s_capture.buffer = (u8*)malloc(header.size))) &&
+              fread(s_capture.buffer, header.size, 1, f) == 1;
+    fclose(f);
+    if (!ok) {
+        TRACE("%s is unreadable or from another build", CAPTURE_PATH);
+        return false;
+    }
+
+    // Index the records, checking every length against the data
+    u32 offset = 0;
+    for (u32 frame = 0; frame < header.frame_count; frame++) {
+        u32 length;
+        if (offset + sizeof(length) > header.size) {
+            TRACE("%s is truncated at frame %u", CAPTURE_PATH, frame);
+            return false;
+        }
+        memcpy(&length, s_capture.buffer + offset, sizeof(length));
+        if (offset + sizeof(length) + length > header.size) {
+            TRACE("%s is truncated at frame %u", CAPTURE_PATH, frame);
+            return false;
+        }
+        s_capture.offsets[frame] = offset;
+        offset += sizeof(length) + length;
+    }
+    s_capture.frame_count = header.frame_count;
+    s_capture.capacity = header.size;
+    s_capture.size = header.size;
+    return true;
+}
+
+// Frames recorded so far, or loaded for replay
+static u32 captureFrameCount() {
+    return s_capture.frame_count;
+}
+
+// Starts reading the given frame's record
+static void replaySeek(u32 frame) {
+    u32 length;
+    memcpy(&length, s_capture.buffer + s_capture.offsets[frame], sizeof(length));
+    s_capture.read = s_capture.offsets[frame] + sizeof(length);
+    s_capture.read_end = s_capture.read + length;
+}
+
+// Reads the next bytes of the current record, false past its end
+static bool replayRead(void* data, u32 size) {
+    if (s_capture.read + size > s_capture.read_end)
+        return false;
+    memcpy(data, s_capture.buffer + s_capture.read, size);
+    s_capture.read += size;
+    return true;
+}
+
+#endif
@@ -0,0 +1,189 @@
+#ifndef __CONFIG_H_
+#define __CONFIG_H_
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+// Runtime options, read from sdmc:/rsbsPLUS-nx/config.ini and then from argv,
+// so command line switches (e.g. through nxlink -a) override the file.
+//
+//   config.ini:  key = value   (one per line, # starts a comment)
+//   argv:        --key=value   or just --key for booleans
+//
+// Reports go through TRACE, so include nxlink.h first.
+
+#define CONFIG_DIR  "sdmc:/rsbsPLUS-nx"
+#define CONFIG_PATH CONFIG_DIR "/config.ini"
+
+struct AppConfig {
+    bool benchmark;
+    int benchmark_frames;        // measured frames, after the warm-up
+    int benchmark_warmup_frames; // frames rendered before measuring starts
+    u32 benchmark_seed;
+    int benchmark_pacing;        // PacingMode used while benchmarking
+    int instances;
+    int lod;                     // sphere subdivision level, -1 picks one per instance
+    int framebuffer;             // FramebufferProfile
+    bool late_latch;             // sample the pad again right before the frame's transform is built
+    bool sim_thread;             // simulate on a separate core, benchmarks always simulate inline
+    int perf_profile;            // PerfProfile: clocks, pacing and instance budget
+    bool hud;                    // performance overlay shown at startup
+    float reveal_duration;       // seconds for a full color sweep
+    bool capture;                // set aside a capture buffer at startup, for L + X
+    int capture_frames;          // frames recorded per capture
+    bool replay;                 // render the capture in a loop instead of simulating
+    int replay_frame;            // single captured frame to repeat, -1 loops them all
+    bool dynamic_resolution;
+    float min_resolution_scale;  // lowest render scale per axis
+};
+
+static void configDefaults(AppConfig* config) {
+    config->benchmark = false;
+    config->benchmark_frames = 3600;
+    config->benchmark_warmup_frames = 120;
+    config->benchmark_seed = 0x5eed;
+    config->benchmark_pacing = 2; // uncapped
+    config->instances = 1;
+    config->lod = -1;
+    config->framebuffer = 1; // depth
+    config->late_latch = true;
+    config->sim_thread = true;
+    config->perf_profile = 1; // balanced
+    config->hud = false;
+    config->reveal_duration = 0.175f;
+    config->capture = false;
+    config->capture_frames = 120;
+    config->replay = false;
+    config->replay_frame = -1;
+    config->dynamic_resolution = true;
+    config->min_resolution_scale = 0.5f;
+}
+
+static bool configParseBool(const char* value) {
+    return !strcmp(value, "1") || !strcmp(value, "true") || !strcmp(value, "yes") || !strcmp(value, "on");
+}
+
+static int configParsePacing(const char* value) {
+    static const char* const names[] = { "vsync60", "vsync30", "uncapped", "limited" };
+    for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++)
+        if (!strcmp(value, names[i]))
+            return i;
+    return atoi(value);
+}
+
+static int configParseFramebuffer(const char* value) {
+    static const char* const names[] = { "none", "depth", "msaa2x", "msaa4x" };
+    for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++)
+        if (!strcmp(value, names[i]))
+            return i;
+    return atoi(value);
+}
+
+static int configParsePerfProfile(const char* value) {
+    static const char* const names[] = { "battery", "balanced", "max" };
+    for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++)
+        if (!strcmp(value, names[i]))
+            return i;
+    return atoi(value);
+}
+
+static void configSet(AppConfig* config, const char* key, const char* value) {
+    if (!strcmp(key, "benchmark"))
+        config->benchmark = configParseBool(value);
+    else if (!strcmp(key, "benchmark_frames"))
+        config->benchmark_frames = atoi(value);
+    else if (!strcmp(key, "benchmark_warmup_frames"))
+        config->benchmark_warmup_frames = atoi(value);
+    else if (!strcmp(key, "benchmark_seed"))
+        config->benchmark_seed = strtoul(value, nullptr, 0);
+    else if (!strcmp(key, "benchmark_pacing"))
+        config->benchmark_pacing = configParsePacing(value);
+    else if (!strcmp(key, "instances"))
+        config->instances = atoi(value);
+    else if (!strcmp(key, "lod"))
+        config->lod = atoi(value);
+    else if (!strcmp(key, "framebuffer"))
+        config->framebuffer = configParseFramebuffer(value);
+    else if (!strcmp(key, "late_latch"))
+        config->late_latch = configParseBool(value);
+    else if (!strcmp(key, "perf_profile"))
+        config->perf_profile = configParsePerfProfile(value);
+    else if (!strcmp(key, "sim_thread"))
+        config->sim_thread = configParseBool(value);
+    else if (!strcmp(key, "hud"))
+        config->hud = configParseBool(value);
+    else if (!strcmp(key, "reveal_duration"))
+        config->reveal_duration = strtof(value, nullptr);
+    else if (!strcmp(key, "capture"))
+        config->capture = configParseBool(value);
+    else if (!strcmp(key, "capture_frames"))
+        config->capture_frames = atoi(value);
+    else if (!strcmp(key, "replay"))
+        config->replay = configParseBool(value);
+    else if (!strcmp(key, "replay_frame"))
+        config->replay_frame = atoi(value);
+    else if (!strcmp(key, "dynamic_resolution"))
+        config->dynamic_resolution = configParseBool(value);
+    else if (!strcmp(key, "min_resolution_scale"))
+        config->min_resolution_scale = strtof(value, nullptr);
+    else
+        TRACE("unknown option '%s'", key);
+}
+
+static char* configTrim(char* s) {
+    while (isspace((unsigned char)*s))
+        s++;
+    char* end = s + strlen(s);
+    while (end > s && isspace((unsigned char)end[-1]))
+        *--end = '\0';
+    return s;
+}
+
+static void configLoadFile(AppConfig* config, const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f)
+        return;
+
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        char* comment = strchr(line, '#');
+        if (comment)
+            *comment = '\0';
+        char* eq = strchr(line, '=');
+        if (!eq)
+            continue;
+        *eq = '\0';
+        configSet(config, configTrim(line), configTrim(eq + 1));
+    }
+    fclose(f);
+    TRACE("loaded %s", path);
+}
+
+static void configParseArgs(AppConfig* config, int argc, char* argv[]) {
+    // argv[0] is the path of the executable
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--", 2) != 0)
+            continue;
+
+        char arg[128];
+        snprintf(arg, sizeof(arg), "%s", argv[i] + 2);
+        char* eq = strchr(arg, '=');
+        if (eq) {
+            *eq = '\0';
+            configSet(config, arg, eq + 1);
+        }
+        else {
+            configSet(config, arg, "1");
+        }
+    }
+}
+
+static void configLoad(AppConfig* config, int argc, char* argv[]) {
+    configDefaults(config);
+    configLoadFile(config, CONFIG_PATH);
+    configParseArgs(config, argc, argv);
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef __FRAMEBUFFER_H_
+#define __FRAMEBUFFER_H_
+
+#include <switch.h>
+#include <EGL/egl.h>
+
+// Framebuffer profiles: which depth and multisample attachments the scene
+// renders with. They are picked once at EGL config time; whichever target the
+// scene draws into (the window or the offscreen dynamic resolution target) gets
+// them, the other one only gets color. Stencil is never used.
+
+enum FramebufferProfile {
+    FramebufferProfile_NoDepth,
+    FramebufferProfile_Depth,
+    FramebufferProfile_Msaa2x, // depth + 2x MSAA
+    FramebufferProfile_Msaa4x, // depth + 4x MSAA
+    FramebufferProfile_Count
+};
+
+struct FramebufferProfileDesc {
+    const char* name;
+    int depth_bits;
+    int samples;
+};
+
+static const FramebufferProfileDesc s_framebuffer_profiles[FramebufferProfile_Count] = {
+    { "none",   0,  1 },
+    { "depth",  24, 1 },
+    { "msaa2x", 24, 2 },
+    { "msaa4x", 24, 4 },
+};
+
+#define FRAMEBUFFER_MAX_EGL_ATTRIBUTES 19
+
+// EGL attribute list for the window surface. scene_in_window is false when the
+// scene renders offscreen and the window only receives the upscaled result.
+static void framebufferEglAttributes(FramebufferProfile profile, bool scene_in_window, EGLint* attributes) {
+    const FramebufferProfileDesc& desc = s_framebuffer_profiles[profile];
+    int n = 0;
+    attributes[n++] = EGL_RENDERABLE_TYPE; attributes[n++] = EGL_OPENGL_BIT;
+    attributes[n++] = EGL_RED_SIZE;        attributes[n++] = 8;
+    attributes[n++] = EGL_GREEN_SIZE;      attributes[n++] = 8;
+    attributes[n++] = EGL_BLUE_SIZE;       attributes[n++] = 8;
+    attributes[n++] = EGL_ALPHA_SIZE;      attributes[n++] = 8;
+    attributes[n++] = EGL_DEPTH_SIZE;      attributes[n++] = scene_in_window ? desc.depth_bits : 0;
+    attributes[n++] = EGL_STENCIL_SIZE;    attributes[n++] = 0;
+    if (scene_in_window && desc.samples > 1) {
+        attributes[n++] = EGL_SAMPLE_BUFFERS; attributes[n++] = 1;
+        attributes[n++] = EGL_SAMPLES;        attributes[n++] = desc.samples;
+    }
+    attributes[n++] = EGL_NONE;
+}
+
+// Memory of the scene's attachments at the given size, resolve targets included
+static u64 framebufferBytes(FramebufferProfile profile, int width, int height) {
+    const FramebufferProfileDesc& desc = s_framebuffer_profiles[profile];
+    u64 pixels = (u64)width * height;
+    u64 bytes = pixels * 4 * desc.samples;           // RGBA8
+    if (desc.depth_bits)
+        bytes += pixels * 4 * desc.samples;          // 24-bit depth is stored in 32 bits
+    if (desc.samples > 1)
+        bytes += pixels * 4;                         // single-sample resolve
+    return bytes;
+}
+
+#endif
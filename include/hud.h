@@ -0,0 +1,211 @@
+#ifndef __HUD_H_
+#define __HUD_H_
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+
+#include <switch.h>
+#include <glad/glad.h>
+
+// Text overlay for reading stats without a PC attached. Glyphs come from a
+// built-in 5x7 font baked into a one-row R8 atlas at init. Every character is
+// one instance of a quad generated from gl_VertexID, so the whole HUD is a
+// single glDrawArraysInstanced. Glyph instances are copied into a persistently
+// mapped ring, one slice per frame in flight, guarded by the caller's fences.
+// Text is only formatted when the caller changes it, drawing is a memcpy.
+
+#define HUD_FIRST_CHAR 0x20 // ' ', everything up to '_' is in the font
+#define HUD_CHAR_COUNT 64
+#define HUD_GLYPH_WIDTH 5
+#define HUD_GLYPH_HEIGHT 7
+#define HUD_CELL_WIDTH 6     // one column of spacing
+#define HUD_CELL_HEIGHT 9    // two rows of spacing
+#define HUD_SCALE 2          // window pixels per font pixel
+#define HUD_MARGIN 16
+#define HUD_MAX_GLYPHS 1024
+#define HUD_LINE_LENGTH 64
+
+// Columns of each glyph, least significant bit at the top
+static const u8 s_hud_font[HUD_CHAR_COUNT][HUD_GLYPH_WIDTH] = {
+    { 0x00, 0x00, 0x00, 0x00, 0x00 }, { 0x00, 0x00, 0x5F, 0x00, 0x00 }, { 0x00, 0x07, 0x00, 0x07, 0x00 }, { 0x14, 0x7F, 0x14, 0x7F, 0x14 }, //  !"#
+    { 0x24, 0x2A, 0x7F, 0x2A, 0x12 }, { 0x23, 0x13, 0x08, 0x64, 0x62 }, { 0x36, 0x49, 0x55, 0x22, 0x50 }, { 0x00, 0x05, 0x03, 0x00, 0x00 }, // $%&'
+    { 0x00, 0x1C, 0x22, 0x41, 0x00 }, { 0x00, 0x41, 0x22, 0x1C, 0x00 }, { 0x08, 0x2A, 0x1C, 0x2A, 0x08 }, { 0x08, 0x08, 0x3E, 0x08, 0x08 }, // ()*+
+    { 0x00, 0x50, 0x30, 0x00, 0x00 }, { 0x08, 0x08, 0x08, 0x08, 0x08 }, { 0x00, 0x60, 0x60, 0x00, 0x00 }, { 0x20, 0x10, 0x08, 0x04, 0x02 }, // ,-./
+    { 0x3E, 0x51, 0x49, 0x45, 0x3E }, { 0x00, 0x42, 0x7F, 0x40, 0x00 }, { 0x42, 0x61, 0x51, 0x49, 0x46 }, { 0x21, 0x41, 0x45, 0x4B, 0x31 }, // 0123
+    { 0x18, 0x14, 0x12, 0x7F, 0x10 }, { 0x27, 0x45, 0x45, 0x45, 0x39 }, { 0x3C, 0x4A, 0x49, 0x49, 0x30 }, { 0x01, 0x71, 0x09, 0x05, 0x03 }, // 4567
+    { 0x36, 0x49, 0x49, 0x49, 0x36 }, { 0x06, 0x49, 0x49, 0x29, 0x1E }, { 0x00, 0x36, 0x36, 0x00, 0x00 }, { 0x00, 0x56, 0x36, 0x00, 0x00 }, // 89:;
+    { 0x00, 0x08, 0x14, 0x22, 0x41 }, { 0x14, 0x14, 0x14, 0x14, 0x14 }, { 0x41, 0x22, 0x14, 0x08, 0x00 }, { 0x02, 0x01, 0x51, 0x09, 0x06 }, // <=>?
+    { 0x32, 0x49, 0x79, 0x41, 0x3E }, { 0x7E, 0x11, 0x11, 0x11, 0x7E }, { 0x7F, 0x49, 0x49, 0x49, 0x36 }, { 0x3E, 0x41, 0x41, 0x41, 0x22 }, // @ABC
+    { 0x7F, 0x41, 0x41, 0x22, 0x1C }, { 0x7F, 0x49, 0x49, 0x49, 0x41 }, { 0x7F, 0x09, 0x09, 0x01, 0x01 }, { 0x3E, 0x41, 0x41, 0x51, 0x32 }, // DEFG
+    { 0x7F, 0x08, 0x08, 0x08, 0x7F }, { 0x00, 0x41, 0x7F, 0x41, 0x00 }, { 0x20, 0x40, 0x41, 0x3F, 0x01 }, { 0x7F, 0x08, 0x14, 0x22, 0x41 }, // HIJK
+    { 0x7F, 0x40, 0x40, 0x40, 0x40 }, { 0x7F, 0x02, 0x04, 0x02, 0x7F }, { 0x7F, 0x04, 0x08, 0x10, 0x7F }, { 0x3E, 0x41, 0x41, 0x41, 0x3E }, // LMNO
+    { 0x7F, 0x09, 0x09, 0x09, 0x06 }, { 0x3E, 0x41, 0x51, 0x21, 0x5E }, { 0x7F, 0x09, 0x19, 0x29, 0x46 }, { 0x46, 0x49, 0x49, 0x49, 0x31 }, // PQRS
+    { 0x01, 0x01, 0x7F, 0x01, 0x01 }, { 0x3F, 0x40, 0x40, 0x40, 0x3F }, { 0x1F, 0x20, 0x40, 0x20, 0x1F }, { 0x7F, 0x20, 0x18, 0x20, 0x7F }, // TUVW
+    { 0x63, 0x14, 0x08, 0x14, 0x63 }, { 0x03, 0x04, 0x78, 0x04, 0x03 }, { 0x61, 0x51, 0x49, 0x45, 0x43 }, { 0x00, 0x7F, 0x41, 0x41, 0x00 }, // XYZ[
+    { 0x02, 0x04, 0x08, 0x10, 0x20 }, { 0x00, 0x41, 0x41, 0x7F, 0x00 }, { 0x04, 0x02, 0x01, 0x02, 0x04 }, { 0x40, 0x40, 0x40, 0x40, 0x40 }, // \]^_
+};
+
+static const char* const hudVertexShaderSource = R"text(
+    #version 330 core
+
+    // x, y: top left in pixels, z: glyph index
+    layout (location = 0) in vec4 aGlyph;
+
+    uniform vec4 hudParams; // xy: 2 / viewport size, zw: cell size in pixels
+
+    noperspective out vec2 texel;
+
+    void main()
+    {
+        vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+        vec2 pixel = aGlyph.xy + corner * hudParams.zw;
+        gl_Position = vec4(pixel.x * hudParams.x - 1.0, 1.0 - pixel.y * hudParams.y, 0.0, 1.0);
+        texel = vec2((aGlyph.z + corner.x) * 6.0, corner.y * 9.0);
+    }
+)text";
+
+static const char* const hudFragmentShaderSource = R"text(
+    #version 330 core
+
+    uniform sampler2D font;
+
+    noperspective in vec2 texel;
+
+    out vec4 fragColor;
+
+    void main()
+    {
+        // Text on a translucent backdrop, so it stays readable over the scene
+        float ink = texelFetch(font, ivec2(texel), 0).r;
+        fragColor = mix(vec4(0.0, 0.0, 0.0, 0.6), vec4(1.0, 1.0, 0.6, 1.0), ink);
+    }
+)text";
+
+struct HudGlyph {
+    float x, y;
+    float glyph;
+    float unused;
+};
+
+static struct {
+    GLuint program;
+    GLint params_location;
+    int params_width, params_height; // window size hudParams was last set for
+    GLuint vao;
+    GLuint font_texture;
+    GLuint glyph_buffer;
+    HudGlyph* glyph_map;
+
+    HudGlyph glyphs[HUD_MAX_GLYPHS];
+    int glyph_count;
+} s_hud;
+
+// program is linked from hudVertexShaderSource and hudFragmentShaderSource,
+// slices is the number of frames in flight the caller keeps fences for
+static void hudInit(GLuint program, int slices) {
+    s_hud.program = program;
+    s_hud.params_location = glGetUniformLocation(program, "hudParams");
+    glProgramUniform1i(program, glGetUniformLocation(program, "font"), 0);
+    // Nothing else blends, so the function is set once and only GL_BLEND toggles
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    // One row of cells, the spacing around each glyph stays empty
+    const int width = HUD_CHAR_COUNT * HUD_CELL_WIDTH;
+    static u8 atlas[HUD_CELL_HEIGHT][HUD_CHAR_COUNT * HUD_CELL_WIDTH];
+    for (int c = 0; c < HUD_CHAR_COUNT; c++)
+        for (int x = 0; x < HUD_GLYPH_WIDTH; x++)
+            for (int y = 0; y < HUD_GLYPH_HEIGHT; y++)
+                atlas[y + 1][c * HUD_CELL_WIDTH + x] = (s_hud_font[c][x] >> y) & 1 ? 0xFF : 0x00;
+    glGenTextures(1, &s_hud.font_texture);
+    glBindTexture(GL_TEXTURE_2D, s_hud.font_texture);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8, width, HUD_CELL_HEIGHT);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, HUD_CELL_HEIGHT, GL_RED, GL_UNSIGNED_BYTE, atlas);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    const GLbitfield map_flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    const GLsizeiptr size = sizeof(s_hud.glyphs) * slices;
+    glGenBuffers(1, &s_hud.glyph_buffer);
+    glBindBuffer(GL_ARRAY_BUFFER, s_hud.glyph_buffer);
+    glBufferStorage(GL_ARRAY_BUFFER, size, nullptr, map_flags);
+    s_hud.glyph_map = (HudGlyph*)glMapBufferRange(GL_ARRAY_BUFFER, 0, size, map_flags);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glGenVertexArrays(1, &s_hud.vao);
+    glBindVertexArray(s_hud.vao);
+    glVertexAttribFormat(0, 4, GL_FLOAT, GL_FALSE, 0);
+    glVertexAttribBinding(0, 0);
+    glEnableVertexAttribArray(0);
+    glVertexBindingDivisor(0, 1);
+    glBindVertexArray(0);
+}
+
+static void hudExit() {
+    glBindBuffer(GL_ARRAY_BUFFER, s_hud.glyph_buffer);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDeleteBuffers(1, &s_hud.glyph_buffer);
+    glDeleteVertexArrays(1, &s_hud.vao);
+    glDeleteTextures(1, &s_hud.font_texture);
+    glDeleteProgram(s_hud.program);
+}
+
+static void hudClear() {
+    s_hud.glyph_count = 0;
+}
+
+// Appends a line of text at the given row, lowercase is shown as uppercase
+static void hudPrint(int row, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+static void hudPrint(int row, const char* fmt, ...) {
+    char line[HUD_LINE_LENGTH];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+
+    const float y = HUD_MARGIN + row * HUD_CELL_HEIGHT * HUD_SCALE;
+    for (int column = 0; line[column] && s_hud.glyph_count < HUD_MAX_GLYPHS; column++) {
+        int c = toupper((unsigned char)line[column]) - HUD_FIRST_CHAR;
+        if (c < 0 || c >= HUD_CHAR_COUNT)
+            c = '?' - HUD_FIRST_CHAR;
+        HudGlyph& glyph = s_hud.glyphs[s_hud.glyph_count++];
+        glyph.x = HUD_MARGIN + column * HUD_CELL_WIDTH * HUD_SCALE;
+        glyph.y = y;
+        glyph.glyph = (float)c;
+        glyph.unused = 0.0f;
+    }
+}
+
+// Draws into the bound framebuffer, which must be width x height. Blending is
+// disabled again on return, the HUD's program and VAO are left for the caller
+// to replace.
+static void hudDraw(int slice, int width, int height) {
+    if (s_hud.glyph_count == 0)
+        return;
+
+    HudGlyph* out = s_hud.glyph_map + slice * HUD_MAX_GLYPHS;
+    memcpy(out, s_hud.glyphs, s_hud.glyph_count * sizeof(HudGlyph));
+
+    glViewport(0, 0, width, height);
+    glUseProgram(s_hud.program);
+    // Only changes with the window, on docking or undocking
+    if (width != s_hud.params_width || height != s_hud.params_height) {
+        s_hud.params_width = width;
+        s_hud.params_height = height;
+        glProgramUniform4f(s_hud.program, s_hud.params_location, 2.0f / width, 2.0f / height,
+                           HUD_CELL_WIDTH * HUD_SCALE, HUD_CELL_HEIGHT * HUD_SCALE);
+    }
+    glBindVertexArray(s_hud.vao);
+    glBindVertexBuffer(0, s_hud.glyph_buffer, slice * sizeof(s_hud.glyphs), sizeof(HudGlyph));
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, s_hud.font_texture);
+    glEnable(GL_BLEND);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, s_hud.glyph_count);
+    glDisable(GL_BLEND);
+}
+
+#endif
@@ -0,0 +1,172 @@
+#ifndef __ICOSPHERE_H_
+#define __ICOSPHERE_H_
+
+#include <math.h>
+
+#include <switch.h>
+#include <glad/glad.h>
+
+#include <mesh.h>
+
+// Procedural sphere: an icosahedron whose triangles are split in four per
+// subdivision level, with every new vertex pushed out onto the sphere. Level 1
+// is the shape the old hardcoded table described. All levels are generated at
+// compile time into one IcosphereLods table.
+
+#define ICOSPHERE_MAX_LEVEL 4
+#define ICOSPHERE_LEVEL_COUNT (ICOSPHERE_MAX_LEVEL + 1)
+
+// Level 0 edge length relative to the radius, subdivision halves it
+#define ICOSPHERE_EDGE_FACTOR 1.0515f
+
+constexpr int icosphereVertexCount(int level) {
+    return level == 0 ? 12 : 4 * icosphereVertexCount(level - 1) - 6;
+}
+
+constexpr int icosphereTriangleCount(int level) {
+    return level == 0 ? 20 : 4 * icosphereTriangleCount(level - 1);
+}
+
+constexpr int icosphereTotalVertexCount(int max_level) {
+    return max_level < 0 ? 0 : icosphereVertexCount(max_level) + icosphereTotalVertexCount(max_level - 1);
+}
+
+constexpr int icosphereTotalIndexCount(int max_level) {
+    return max_level < 0 ? 0 : 3 * icosphereTriangleCount(max_level) + icosphereTotalIndexCount(max_level - 1);
+}
+
+#define ICOSPHERE_MAX_VERTICES icosphereVertexCount(ICOSPHERE_MAX_LEVEL)
+#define ICOSPHERE_MAX_INDICES (3 * icosphereTriangleCount(ICOSPHERE_MAX_LEVEL))
+// Open addressed midpoint table, power of two
+#define ICOSPHERE_EDGE_CAPACITY 8192
+
+static_assert(ICOSPHERE_MAX_VERTICES <= 0x10000, "icosphere indices must fit in GLushort");
+// The last subdivision splits 3/2 * triangles edges, keep the table at most half full
+static_assert(ICOSPHERE_EDGE_CAPACITY >= 3 * icosphereTriangleCount(ICOSPHERE_MAX_LEVEL - 1), "icosphere edge table too small");
+
+struct IcosphereLod {
+    MeshDesc mesh;
+    int base_vertex;
+    int first_index;
+};
+
+// Every level in one vertex table and one index list, drawn with a base vertex
+struct IcosphereLods {
+    MeshPosition vertices[icosphereTotalVertexCount(ICOSPHERE_MAX_LEVEL)];
+    GLushort indices[icosphereTotalIndexCount(ICOSPHERE_MAX_LEVEL)];
+    IcosphereLod levels[ICOSPHERE_LEVEL_COUNT];
+};
+
+// Finds or creates the vertex halfway along a -> b. edge_keys / edge_values form
+// an open addressed table keyed by the ordered vertex pair.
+constexpr int icosphereMidpoint(MeshPosition* vertices, int* vertex_count, u64* edge_keys, int* edge_values, int a, int b, float radius) {
+    u64 key = a < b ? ((u64)a << 32) | (u32)b : ((u64)b << 32) | (u32)a;
+    u32 slot = (u32)((key * 0x9e3779b97f4a7c15ULL) >> 32) & (ICOSPHERE_EDGE_CAPACITY - 1);
+    while (edge_values[slot] >= 0) {
+        if (edge_keys[slot] == key)
+            return edge_values[slot];
+        slot = (slot + 1) & (ICOSPHERE_EDGE_CAPACITY - 1);
+    }
+
+    int v = (*vertex_count)++;
+    vertices[v] = meshScaleTo(meshAdd(vertices[a], vertices[b]), radius);
+    edge_keys[slot] = key;
+    edge_values[slot] = v;
+    return v;
+}
+
+// Writes icosphereVertexCount(level) vertices and 3 * icosphereTriangleCount(level)
+// indices, counter-clockwise seen from outside, then optimizes them for the GPU.
+constexpr MeshDesc icosphereBuild(int level, float radius, MeshPosition* vertices, GLushort* indices) {
+    const GLushort faces[20 * 3] = {
+        0, 11, 5,   0, 5, 1,    0, 1, 7,    0, 7, 10,   0, 10, 11,
+        1, 5, 9,    5, 11, 4,   11, 10, 2,  10, 7, 6,   7, 1, 8,
+        3, 9, 4,    3, 4, 2,    3, 2, 6,    3, 6, 8,    3, 8, 9,
+        4, 9, 5,    2, 4, 11,   6, 2, 10,   8, 6, 7,    9, 8, 1,
+    };
+
+    const float t = 1.6180340f; // golden ratio
+    const MeshPosition corners[12] = {
+        { -1,  t,  0 }, {  1,  t,  0 }, { -1, -t,  0 }, {  1, -t,  0 },
+        {  0, -1,  t }, {  0,  1,  t }, {  0, -1, -t }, {  0,  1, -t },
+        {  t,  0, -1 }, {  t,  0,  1 }, { -t,  0, -1 }, { -t,  0,  1 },
+    };
+
+    int vertex_count = 12;
+    for (int v = 0; v < 12; v++)
+        vertices[v] = meshScaleTo(corners[v], radius);
+    for (int i = 0; i < 20 * 3; i++)
+        indices[i] = faces[i];
+
+    int triangle_count = 20;
+    GLushort scratch[ICOSPHERE_MAX_INDICES] = {};
+    u64 edge_keys[ICOSPHERE_EDGE_CAPACITY] = {};
+    int edge_values[ICOSPHERE_EDGE_CAPACITY] = {};
+
+    for (int l = 0; l < level; l++) {
+        for (int e = 0; e < ICOSPHERE_EDGE_CAPACITY; e++)
+            edge_values[e] = -1;
+        int out = 0;
+        for (int tri = 0; tri < triangle_count; tri++) {
+            int a = indices[tri * 3 + 0], b = indices[tri * 3 + 1], c = indices[tri * 3 + 2];
+            int ab = icosphereMidpoint(vertices, &vertex_count, edge_keys, edge_values, a, b, radius);
+            int bc = icosphereMidpoint(vertices, &vertex_count, edge_keys, edge_values, b, c, radius);
+            int ca = icosphereMidpoint(vertices, &vertex_count, edge_keys, edge_values, c, a, radius);
+            const int split[12] = { a, ab, ca,   b, bc, ab,   c, ca, bc,   ab, bc, ca };
+            for (int i = 0; i < 12; i++)
+                scratch[out++] = (GLushort)split[i];
+        }
+        triangle_count *= 4;
+        for (int i = 0; i < triangle_count * 3; i++)
+            indices[i] = scratch[i];
+    }
+
+    return meshOptimize<ICOSPHERE_MAX_VERTICES, ICOSPHERE_MAX_INDICES>(vertices, vertex_count, indices, triangle_count * 3);
+}
+
+constexpr IcosphereLods icosphereBuildLods(float radius) {
+    IcosphereLods lods = {};
+    int base_vertex = 0, first_index = 0;
+    for (int level = 0; level < ICOSPHERE_LEVEL_COUNT; level++) {
+        IcosphereLod& lod = lods.levels[level];
+        lod.base_vertex = base_vertex;
+        lod.first_index = first_index;
+        lod.mesh = icosphereBuild(level, radius, &lods.vertices[base_vertex], &lods.indices[first_index]);
+        base_vertex += lod.mesh.vertex_count;
+        first_index += lod.mesh.index_count;
+    }
+    return lods;
+}
+
+// Everything the generator promises, checked with static_assert where the table is defined
+constexpr bool icosphereLodsValid(const IcosphereLods& lods, float radius) {
+    for (int level = 0; level < ICOSPHERE_LEVEL_COUNT; level++) {
+        const IcosphereLod& lod = lods.levels[level];
+        const MeshPosition* vertices = &lods.vertices[lod.base_vertex];
+        const GLushort* indices = &lods.indices[lod.first_index];
+
+        if (lod.mesh.vertex_count != icosphereVertexCount(level) || lod.mesh.triangle_count != icosphereTriangleCount(level))
+            return false;
+        if (!meshIndicesInRange(indices, lod.mesh.index_count, lod.mesh.vertex_count))
+            return false;
+        if (!meshWoundOutward(vertices, indices, lod.mesh.index_count, lod.mesh.center))
+            return false;
+        for (int v = 0; v < lod.mesh.vertex_count; v++) {
+            float r2 = meshDot(vertices[v], vertices[v]);
+            if (r2 < radius * radius * 0.999f || r2 > radius * radius * 1.001f)
+                return false;
+        }
+    }
+    return true;
+}
+
+// Lowest level whose edges are at most target_edge_px long at the given projected radius
+static int icosphereLevelForRadius(float radius_px, float target_edge_px) {
+    float edges_per_target = ICOSPHERE_EDGE_FACTOR * radius_px / target_edge_px;
+    if (edges_per_target <= 1.0f)
+        return 0;
+    int level = (int)ceilf(log2f(edges_per_target));
+    return level > ICOSPHERE_MAX_LEVEL ? ICOSPHERE_MAX_LEVEL : level;
+}
+
+#endif
@@ -0,0 +1,173 @@
+#ifndef __JOBS_H_
+#define __JOBS_H_
+
+#include <stdint.h>
+#include <atomic>
+
+#include <switch.h>
+
+#include <profiler.h>
+
+// Job system for data parallel loops over cores 0-2. Cores 1 and 2 get a
+// worker thread each, the thread calling jobsParallelFor (the render thread, on
+// core 0) joins in as worker 0. A parallel for cuts its range into chunks and
+// deals them out as one fixed contiguous run per worker. Every run has a shared
+// counter: a worker claims chunks from its own run with a fetch_add and, once
+// that is empty, claims from the other runs the same way, so a late or missing
+// worker only costs balance. There are no per-worker queues and nothing is
+// allocated after jobsInit.
+// Reports go through TRACE, so include nxlink.h first.
+
+#define JOBS_WORKERS PROFILER_CORES
+#define JOBS_STACK_SIZE 0x4000
+// Below the main and simulation threads, which share cores 0 and 1 with the
+// workers: a simulation step preempts a worker, whose chunks the others take over
+#define JOBS_PRIORITY 0x2D
+#define JOBS_SPIN_LIMIT 2048 // polls of the last chunks before the caller sleeps
+
+typedef void (*JobsRangeFn)(void* ctx, int begin, int end);
+
+// Chunk indices still to claim from a worker's run, alone in its cache line
+struct alignas(64) JobsRun {
+    std::atomic<int> next;
+    int end;
+};
+
+static struct {
+    Thread threads[JOBS_WORKERS];
+    bool started[JOBS_WORKERS];
+    Mutex mutex;
+    CondVar wake;
+    CondVar done; // a worker left the current parallel for
+    bool running;
+    u32 generation; // bumped for every parallel for, under the mutex
+
+    // The current parallel for, only written while no worker is inside it
+    JobsRangeFn fn;
+    void* ctx;
+    int count;
+    int grain;
+    JobsRun runs[JOBS_WORKERS];
+    std::atomic<int> remaining; // chunks not finished yet
+    std::atomic<int> active;    // workers taking part in the current one, changed under the mutex
+} s_jobs;
+
+// Claims and runs chunks until every run is empty, starting with its own
+static void jobsWork(int worker) {
+    u64 start = armGetSystemTick();
+    int done = 0;
+    for (int i = 0; i < JOBS_WORKERS; i++) {
+        JobsRun* run = &s_jobs.runs[(worker + i) % JOBS_WORKERS];
+        for (;;) {
+            int chunk = run->next.fetch_add(1, std::memory_order_relaxed);
+            if (chunk >= run->end)
+                break;
+            int begin = chunk * s_jobs.grain;
+            int end = begin + s_jobs.grain < s_jobs.count ? begin + s_jobs.grain : s_jobs.count;
+            s_jobs.fn(s_jobs.ctx, begin, end);
+            done++;
+        }
+    }
+    if (done)
+        s_jobs.remaining.fetch_sub(done, std::memory_order_release);
+    profilerCoreBusy(worker, armGetSystemTick() - start);
+}
+
+static void jobsThreadMain(void* arg) {
+    int worker = (int)(uintptr_t)arg;
+    u32 seen = 0;
+
+    mutexLock(&s_jobs.mutex);
+    for (;;) {
+        while (s_jobs.running && s_jobs.generation == seen)
+            condvarWait(&s_jobs.wake, &s_jobs.mutex);
+        if (!s_jobs.running)
+            break;
+        seen = s_jobs.generation;
+        s_jobs.active.fetch_add(1, std::memory_order_relaxed);
+        mutexUnlock(&s_jobs.mutex);
+
+        jobsWork(worker);
+        mutexLock(&s_jobs.mutex);
+        s_jobs.active.fetch_sub(1, std::memory_order_release);
+        condvarWakeAll(&s_jobs.done);
+    }
+    mutexUnlock(&s_jobs.mutex);
+}
+
+static void jobsInit() {
+    mutexInit(&s_jobs.mutex);
+    condvarInit(&s_jobs.wake);
+    condvarInit(&s_jobs.done);
+    s_jobs.running = true;
+
+    for (int worker = 1; worker < JOBS_WORKERS; worker++) {
+        if (R_FAILED(threadCreate(&s_jobs.threads[worker], jobsThreadMain, (void*)(uintptr_t)worker, nullptr,
+                                  JOBS_STACK_SIZE, JOBS_PRIORITY, worker))) {
+            TRACE("no worker on core %d, the others take over its chunks", worker);
+            continue;
+        }
+        threadStart(&s_jobs.threads[worker]);
+        s_jobs.started[worker] = true;
+    }
+}
+
+static void jobsExit() {
+    mutexLock(&s_jobs.mutex);
+    s_jobs.running = false;
+    condvarWakeAll(&s_jobs.wake);
+    mutexUnlock(&s_jobs.mutex);
+
+    for (int worker = 1; worker < JOBS_WORKERS; worker++) {
+        if (!s_jobs.started[worker])
+            continue;
+        threadWaitForExit(&s_jobs.threads[worker]);
+        threadClose(&s_jobs.threads[worker]);
+        s_jobs.started[worker] = false;
+    }
+}
+
+// Calls fn over [0, count) in ranges of at most grain items and returns once all
+// of them are done. fn runs concurrently on every core, ranges never overlap.
+static void jobsParallelFor(int count, int grain, JobsRangeFn fn, void* ctx) {
+    if (count <= 0)
+        return;
+    int chunks = (count + grain - 1) / grain;
+    if (chunks == 1 || !s_jobs.running) {
+        u64 start = armGetSystemTick();
+        fn(ctx, 0, count);
+        profilerCoreBusy(0, armGetSystemTick() - start);
+        return;
+    }
+
+    mutexLock(&s_jobs.mutex);
+    // A worker that woke up late may still be looking at the previous one
+    while (s_jobs.active.load(std::memory_order_acquire) != 0)
+        condvarWait(&s_jobs.done, &s_jobs.mutex);
+    s_jobs.fn = fn;
+    s_jobs.ctx = ctx;
+    s_jobs.count = count;
+    s_jobs.grain = grain;
+    for (int worker = 0; worker < JOBS_WORKERS; worker++) {
+        s_jobs.runs[worker].next.store(chunks * worker / JOBS_WORKERS, std::memory_order_relaxed);
+        s_jobs.runs[worker].end = chunks * (worker + 1) / JOBS_WORKERS;
+    }
+    s_jobs.remaining.store(chunks, std::memory_order_relaxed);
+    s_jobs.generation++;
+    condvarWakeAll(&s_jobs.wake);
+    mutexUnlock(&s_jobs.mutex);
+
+    jobsWork(0);
+    // The others are at most one chunk away from done, so poll briefly before
+    // sleeping until a worker leaves; each one wakes the caller on its way out
+    for (int spin = 0; spin < JOBS_SPIN_LIMIT && s_jobs.remaining.load(std::memory_order_acquire) != 0; spin++)
+        ;
+    if (s_jobs.remaining.load(std::memory_order_acquire) != 0) {
+        mutexLock(&s_jobs.mutex);
+        while (s_jobs.remaining.load(std::memory_order_acquire) != 0)
+            condvarWait(&s_jobs.done, &s_jobs.mutex);
+        mutexUnlock(&s_jobs.mutex);
+    }
+}
+
+#endif
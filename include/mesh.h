@@ -0,0 +1,240 @@
+#ifndef __MESH_H_
+#define __MESH_H_
+
+#include <glad/glad.h>
+
+// Mesh build step, entirely constexpr: meshes are generated, optimized and
+// validated by the compiler and end up as const tables in .rodata. Nothing
+// here allocates, scratch space is sized by the MaxVertices / MaxIndices
+// template arguments instead.
+
+// Post-transform cache size the triangle order is tuned for.
+// Maxwell keeps far more than this in flight, 16 is a safe lower bound.
+#define MESH_VERTEX_CACHE_SIZE 16
+
+// Tightly packed like the GL position stream, so tables upload as they are
+struct MeshPosition {
+    float x, y, z;
+};
+
+// Everything the renderer needs to know about a built mesh. Uploads, the color
+// reveal and draw calls all size themselves from this instead of constants.
+struct MeshDesc {
+    int vertex_count;
+    int index_count;
+    int triangle_count;
+    MeshPosition bounds_min;
+    MeshPosition bounds_max;
+    MeshPosition center; // bounding sphere
+    float radius;
+};
+
+constexpr MeshPosition meshAdd(MeshPosition a, MeshPosition b) {
+    return { a.x + b.x, a.y + b.y, a.z + b.z };
+}
+
+constexpr MeshPosition meshSub(MeshPosition a, MeshPosition b) {
+    return { a.x - b.x, a.y - b.y, a.z - b.z };
+}
+
+constexpr float meshDot(MeshPosition a, MeshPosition b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+constexpr MeshPosition meshCross(MeshPosition a, MeshPosition b) {
+    return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+
+// sqrtf isn't usable in constant expressions, Newton's method converges in a few steps
+constexpr float meshSqrt(float x) {
+    if (x <= 0.0f)
+        return 0.0f;
+    float r = x > 1.0f ? x : 1.0f;
+    for (int i = 0; i < 32; i++)
+        r = 0.5f * (r + x / r);
+    return r;
+}
+
+// p scaled to the given length
+constexpr MeshPosition meshScaleTo(MeshPosition p, float length) {
+    float s = length / meshSqrt(meshDot(p, p));
+    return { p.x * s, p.y * s, p.z * s };
+}
+
+constexpr int meshSkipDeadEnd(const int* live, int* dead_end, int* dead_end_size, int vertex_count, int* cursor) {
+    // Most recently referenced vertices first, they are the most likely to still be cached
+    while (*dead_end_size > 0) {
+        int d = dead_end[--(*dead_end_size)];
+        if (live[d] > 0)
+            return d;
+    }
+    // Otherwise pick up the next vertex in input order that still has work left
+    while (*cursor < vertex_count) {
+        if (live[*cursor] > 0)
+            return *cursor;
+        (*cursor)++;
+    }
+    return -1;
+}
+
+// Reorders the triangles of an index list for the post-transform vertex cache
+// (Tipsify, Sander et al. 2007). Vertices are not moved, only triangles.
+template <int MaxVertices, int MaxIndices>
+constexpr void meshOptimizeVertexCache(GLushort* indices, int index_count, int vertex_count) {
+    const int k = MESH_VERTEX_CACHE_SIZE;
+
+    int live[MaxVertices] = {};
+    int adj_offset[MaxVertices + 1] = {};
+    int adj[MaxIndices] = {};
+    int fill[MaxVertices] = {};
+    int cache_time[MaxVertices] = {};
+    int dead_end[MaxIndices] = {};
+    int candidates[MaxIndices] = {};
+    bool emitted[MaxIndices / 3] = {};
+    GLushort output[MaxIndices] = {};
+
+    // Vertex -> triangle adjacency, stored as a compact offset table
+    for (int i = 0; i < index_count; i++)
+        live[indices[i]]++;
+    for (int v = 0; v < vertex_count; v++)
+        adj_offset[v + 1] = adj_offset[v] + live[v];
+    for (int i = 0; i < index_count; i++) {
+        int v = indices[i];
+        adj[adj_offset[v] + fill[v]++] = i / 3;
+    }
+
+    int dead_end_size = 0;
+    int output_size = 0;
+    int cursor = 0;
+    int timestamp = k + 1;
+    int fan = vertex_count > 0 ? 0 : -1;
+
+    while (fan >= 0) {
+        int candidate_count = 0;
+
+        // Emit every remaining triangle around the fanning vertex
+        for (int a = adj_offset[fan]; a < adj_offset[fan + 1]; a++) {
+            int t = adj[a];
+            if (emitted[t])
+                continue;
+            for (int c = 0; c < 3; c++) {
+                int v = indices[t * 3 + c];
+                output[output_size++] = (GLushort)v;
+                dead_end[dead_end_size++] = v;
+                candidates[candidate_count++] = v;
+                live[v]--;
+                if (timestamp - cache_time[v] > k)
+                    cache_time[v] = timestamp++;
+            }
+            emitted[t] = true;
+        }
+
+        // Next fan: the candidate that stays in cache longest after emitting its remaining triangles
+        int next = -1;
+        int best = -1;
+        for (int n = 0; n < candidate_count; n++) {
+            int v = candidates[n];
+            if (live[v] <= 0)
+                continue;
+            int priority = 0;
+            if (timestamp - cache_time[v] + 2 * live[v] <= k)
+                priority = timestamp - cache_time[v];
+            if (priority > best) {
+                best = priority;
+                next = v;
+            }
+        }
+        if (next < 0)
+            next = meshSkipDeadEnd(live, dead_end, &dead_end_size, vertex_count, &cursor);
+        fan = next;
+    }
+
+    for (int i = 0; i < index_count; i++)
+        indices[i] = output[i];
+}
+
+// Renumbers vertices in the order the index list first references them, so
+// vertex fetches walk memory linearly once the triangles have been reordered.
+template <int MaxVertices>
+constexpr void meshOptimizeVertexFetch(MeshPosition* vertices, GLushort* indices, int index_count, int vertex_count) {
+    int remap[MaxVertices] = {};
+    MeshPosition reordered[MaxVertices] = {};
+    for (int v = 0; v < vertex_count; v++)
+        remap[v] = -1;
+
+    int next = 0;
+    for (int i = 0; i < index_count; i++) {
+        int v = indices[i];
+        if (remap[v] < 0) {
+            remap[v] = next;
+            reordered[next++] = vertices[v];
+        }
+        indices[i] = (GLushort)remap[v];
+    }
+
+    for (int v = 0; v < next; v++)
+        vertices[v] = reordered[v];
+}
+
+constexpr MeshDesc meshDescribe(const MeshPosition* vertices, int vertex_count, int index_count) {
+    MeshDesc desc = {};
+    desc.vertex_count = vertex_count;
+    desc.index_count = index_count;
+    desc.triangle_count = index_count / 3;
+    if (vertex_count == 0)
+        return desc;
+
+    desc.bounds_min = desc.bounds_max = vertices[0];
+    for (int v = 1; v < vertex_count; v++) {
+        const MeshPosition& p = vertices[v];
+        desc.bounds_min = { p.x < desc.bounds_min.x ? p.x : desc.bounds_min.x,
+                            p.y < desc.bounds_min.y ? p.y : desc.bounds_min.y,
+                            p.z < desc.bounds_min.z ? p.z : desc.bounds_min.z };
+        desc.bounds_max = { p.x > desc.bounds_max.x ? p.x : desc.bounds_max.x,
+                            p.y > desc.bounds_max.y ? p.y : desc.bounds_max.y,
+                            p.z > desc.bounds_max.z ? p.z : desc.bounds_max.z };
+    }
+
+    // Box-centered sphere: not minimal, but conservative and cheap
+    desc.center = { (desc.bounds_min.x + desc.bounds_max.x) * 0.5f,
+                    (desc.bounds_min.y + desc.bounds_max.y) * 0.5f,
+                    (desc.bounds_min.z + desc.bounds_max.z) * 0.5f };
+    float radius2 = 0.0f;
+    for (int v = 0; v < vertex_count; v++) {
+        MeshPosition d = meshSub(vertices[v], desc.center);
+        if (meshDot(d, d) > radius2)
+            radius2 = meshDot(d, d);
+    }
+    desc.radius = meshSqrt(radius2);
+    return desc;
+}
+
+// Optimize an indexed mesh for the GPU in place and describe it
+template <int MaxVertices, int MaxIndices>
+constexpr MeshDesc meshOptimize(MeshPosition* vertices, int vertex_count, GLushort* indices, int index_count) {
+    meshOptimizeVertexCache<MaxVertices, MaxIndices>(indices, index_count, vertex_count);
+    meshOptimizeVertexFetch<MaxVertices>(vertices, indices, index_count, vertex_count);
+    return meshDescribe(vertices, vertex_count, index_count);
+}
+
+// Compile-time checks for generated meshes
+
+constexpr bool meshIndicesInRange(const GLushort* indices, int index_count, int vertex_count) {
+    for (int i = 0; i < index_count; i++)
+        if (indices[i] >= vertex_count)
+            return false;
+    return true;
+}
+
+// Every triangle is counter-clockwise seen from outside a convex mesh
+constexpr bool meshWoundOutward(const MeshPosition* vertices, const GLushort* indices, int index_count, MeshPosition center) {
+    for (int i = 0; i + 2 < index_count; i += 3) {
+        MeshPosition a = vertices[indices[i]], b = vertices[indices[i + 1]], c = vertices[indices[i + 2]];
+        MeshPosition outward = meshSub(meshAdd(meshAdd(a, b), c), { center.x * 3, center.y * 3, center.z * 3 });
+        if (meshDot(meshCross(meshSub(b, a), meshSub(c, a)), outward) <= 0.0f)
+            return false;
+    }
+    return true;
+}
+
+#endif
@@ -1,27 +1,135 @@
 #ifndef ENABLE_NXLINK
-#define TRACE(fmt,...) ((void)0)
+#include <stdio.h>
+
+// Compiled out, the arguments are still checked but never evaluated
+#define TRACE(fmt,...) ((void)sizeof(printf(fmt, ## __VA_ARGS__)))
+#define nxlinkDroppedCount() 0u
 #else
+#include <stdarg.h>
 #include <unistd.h>
-#define TRACE(fmt,...) printf("%s: " fmt "\n", __PRETTY_FUNCTION__, ## __VA_ARGS__)
+#include <atomic>
+
+// TRACE never touches the socket itself: records are formatted into a lock-free
+// single-producer ring and a background thread sends them in batches. When the
+// ring is full, messages are dropped and counted so the render loop never blocks.
+// Only the main thread may TRACE.
+#define TRACE(fmt,...) nxlinkLog("%s: " fmt, __PRETTY_FUNCTION__, ## __VA_ARGS__)
+
+#define NXLINK_LOG_CAPACITY 256 // records, power of two
+#define NXLINK_LOG_RECORD_SIZE 240
+#define NXLINK_LOG_BATCH_SIZE 4096
+#define NXLINK_LOG_IDLE_NS 2000000ULL
+
+struct NxLinkLogRecord {
+    u64 tick;
+    char text[NXLINK_LOG_RECORD_SIZE];
+};
 
 static int s_nxlinkSock = -1;
 
+static NxLinkLogRecord s_nxlinkLog[NXLINK_LOG_CAPACITY];
+static std::atomic<u32> s_nxlinkLogHead(0); // next record to write, owned by the producer
+static std::atomic<u32> s_nxlinkLogTail(0); // next record to send, owned by the drain thread
+static std::atomic<u32> s_nxlinkLogDropped(0);
+static std::atomic<bool> s_nxlinkLogRunning(false);
+static Thread s_nxlinkLogThread;
+
+static void nxlinkLog(const char* fmt, ...) __attribute__((format(printf, 1, 2)));
+static void nxlinkLog(const char* fmt, ...) {
+    if (s_nxlinkSock < 0)
+        return;
+
+    u32 head = s_nxlinkLogHead.load(std::memory_order_relaxed);
+    if (head - s_nxlinkLogTail.load(std::memory_order_acquire) >= NXLINK_LOG_CAPACITY) {
+        s_nxlinkLogDropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    NxLinkLogRecord* record = &s_nxlinkLog[head % NXLINK_LOG_CAPACITY];
+    record->tick = armGetSystemTick();
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(record->text, sizeof(record->text), fmt, args);
+    va_end(args);
+
+    s_nxlinkLogHead.store(head + 1, std::memory_order_release);
+}
+
+static u32 nxlinkDroppedCount() {
+    return s_nxlinkLogDropped.load(std::memory_order_relaxed);
+}
+
+// Sends everything currently queued, batching records into as few writes as possible
+static void nxlinkLogDrain(char* batch, u32* reported_dropped) {
+    size_t size = 0;
+    u32 tail = s_nxlinkLogTail.load(std::memory_order_relaxed);
+    u32 head = s_nxlinkLogHead.load(std::memory_order_acquire);
+
+    u32 dropped = nxlinkDroppedCount();
+    if (dropped != *reported_dropped) {
+        size += snprintf(batch, NXLINK_LOG_BATCH_SIZE, "nxlink: dropped %u messages\n", dropped - *reported_dropped);
+        *reported_dropped = dropped;
+    }
+
+    for (; tail != head; tail++) {
+        const NxLinkLogRecord* record = &s_nxlinkLog[tail % NXLINK_LOG_CAPACITY];
+        if (size + NXLINK_LOG_RECORD_SIZE + 32 > NXLINK_LOG_BATCH_SIZE) {
+            write(s_nxlinkSock, batch, size);
+            size = 0;
+        }
+        size += snprintf(batch + size, NXLINK_LOG_BATCH_SIZE - size, "[%10.3f] %s\n", armTicksToNs(record->tick) * 1e-6, record->text);
+        // Hand the slot back as soon as it has been copied out
+        s_nxlinkLogTail.store(tail + 1, std::memory_order_release);
+    }
+
+    if (size > 0)
+        write(s_nxlinkSock, batch, size);
+}
+
+static void nxlinkLogThreadMain(void* arg) {
+    static char batch[NXLINK_LOG_BATCH_SIZE];
+    u32 reported_dropped = 0;
+
+    while (s_nxlinkLogRunning.load(std::memory_order_acquire)) {
+        nxlinkLogDrain(batch, &reported_dropped);
+        svcSleepThread(NXLINK_LOG_IDLE_NS);
+    }
+    nxlinkLogDrain(batch, &reported_dropped);
+}
+
 static void initNxLink()
 {
     if (R_FAILED(socketInitializeDefault()))
         return;
 
     s_nxlinkSock = nxlinkStdio();
-    if (s_nxlinkSock >= 0)
-        TRACE("printf output now goes to nxlink server");
-    else
+    if (s_nxlinkSock < 0) {
+        socketExit();
+        return;
+    }
+
+    // Lowest priority on the default core, the sends must never preempt rendering
+    s_nxlinkLogRunning = true;
+    if (R_FAILED(threadCreate(&s_nxlinkLogThread, nxlinkLogThreadMain, nullptr, nullptr, 0x4000, 0x3F, -2))) {
+        s_nxlinkLogRunning = false;
+        close(s_nxlinkSock);
         socketExit();
+        s_nxlinkSock = -1;
+        return;
+    }
+    threadStart(&s_nxlinkLogThread);
+
+    TRACE("printf output now goes to nxlink server");
 }
 
 static void deinitNxLink()
 {
     if (s_nxlinkSock >= 0)
     {
+        s_nxlinkLogRunning = false;
+        threadWaitForExit(&s_nxlinkLogThread);
+        threadClose(&s_nxlinkLogThread);
+
         close(s_nxlinkSock);
         socketExit();
         s_nxlinkSock = -1;
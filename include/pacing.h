@@ -0,0 +1,77 @@
+#ifndef __PACING_H_
+#define __PACING_H_
+
+#include <switch.h>
+#include <EGL/egl.h>
+
+// Frame pacing: either let the display's vsync pace eglSwapBuffers (every or
+// every other refresh), run fully uncapped for benchmarking, or run unsynced
+// with a CPU limiter whose target depends on whether the console is docked.
+// Reports go through TRACE, so include nxlink.h first.
+
+enum PacingMode {
+    PacingMode_Vsync60,  // swap interval 1
+    PacingMode_Vsync30,  // swap interval 2
+    PacingMode_Uncapped, // swap interval 0, no limit
+    PacingMode_Limited,  // swap interval 0, sleep to the docked/handheld target
+    PacingMode_Count
+};
+
+static const char* const s_pacing_mode_names[PacingMode_Count] = { "vsync 60", "vsync 30", "uncapped", "limited" };
+
+// Limiter targets in Hz, indexed by AppletOperationMode
+static float pacing_limit_hz[2] = {
+    30.0f, // handheld
+    60.0f, // docked
+};
+
+// Sleeping is coarse, so the last stretch before the deadline is spun instead
+#define PACING_SPIN_NS 500000ULL
+
+static struct {
+    PacingMode mode;
+    u64 last_present_tick;
+} s_pacing = { PacingMode_Vsync60, 0 };
+
+static void pacingSetMode(EGLDisplay display, PacingMode mode) {
+    static const EGLint intervals[PacingMode_Count] = { 1, 2, 0, 0 };
+    s_pacing.mode = mode;
+    eglSwapInterval(display, intervals[mode]);
+    TRACE("pacing: %s", s_pacing_mode_names[mode]);
+}
+
+static void pacingCycleMode(EGLDisplay display) {
+    pacingSetMode(display, (PacingMode)((s_pacing.mode + 1) % PacingMode_Count));
+}
+
+// Frame time the current mode aims for; uncapped still budgets for 60 fps
+static float pacingFrameBudgetMs() {
+    switch (s_pacing.mode) {
+        case PacingMode_Vsync30:
+            return 1000.0f / 30.0f;
+        case PacingMode_Limited:
+            return 1000.0f / pacing_limit_hz[appletGetOperationMode() == AppletOperationMode_Console ? 1 : 0];
+        default:
+            return 1000.0f / 60.0f;
+    }
+}
+
+// Call right before eglSwapBuffers
+static void pacingWait() {
+    u64 now = armGetSystemTick();
+    if (s_pacing.mode == PacingMode_Limited && s_pacing.last_present_tick != 0) {
+        float hz = pacing_limit_hz[appletGetOperationMode() == AppletOperationMode_Console ? 1 : 0];
+        u64 deadline = s_pacing.last_present_tick + armNsToTicks((u64)(1e9f / hz));
+        if (now < deadline) {
+            u64 remaining_ns = armTicksToNs(deadline - now);
+            if (remaining_ns > PACING_SPIN_NS)
+                svcSleepThread(remaining_ns - PACING_SPIN_NS);
+            while (armGetSystemTick() < deadline)
+                ;
+            now = deadline;
+        }
+    }
+    s_pacing.last_present_tick = now;
+}
+
+#endif
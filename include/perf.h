@@ -0,0 +1,130 @@
+#ifndef __PERF_H_
+#define __PERF_H_
+
+#include <switch.h>
+
+#include <pacing.h>
+#include <profiler.h>
+
+// Performance profiles: a CPU/GPU/EMC clock configuration set through apm for
+// each operation mode, paired with the pacing mode and instance budget the
+// clocks are expected to hold. The clocks actually running are read back once
+// a second (clkrst on 8.0.0+, pcv before) and handed to the profiler report.
+// The system restores its own configuration when the application exits.
+// Reports go through TRACE, so include nxlink.h first.
+
+enum PerfProfile {
+    PerfProfile_Battery,
+    PerfProfile_Balanced,
+    PerfProfile_Max,
+    PerfProfile_Count
+};
+
+struct PerfProfileDesc {
+    const char* name;
+    u32 handheld_configuration; // apm performance configuration ids
+    u32 docked_configuration;
+    PacingMode pacing;
+    int instance_budget;
+};
+
+// CPU / GPU / EMC MHz of each configuration as listed on switchbrew
+static const PerfProfileDesc s_perf_profiles[PerfProfile_Count] = {
+    { "battery",  0x00020005, 0x00020006, PacingMode_Vsync30, 256 },  // 1020/307.2/1065.6, 1020/384/1065.6
+    { "balanced", 0x00010000, 0x00010001, PacingMode_Vsync60, 1024 }, // system defaults: 1020/384/1600, 1020/768/1600
+    { "max",      0x92220007, 0x00010001, PacingMode_Vsync60, 4096 }, // 1020/460.8/1600, 1020/768/1600
+};
+
+enum PerfClock {
+    PerfClock_Cpu,
+    PerfClock_Gpu,
+    PerfClock_Emc,
+    PerfClock_Count
+};
+
+static struct {
+    bool apm;
+    bool clkrst;
+    bool pcv;
+    ClkrstSession sessions[PerfClock_Count];
+    PerfProfile profile;
+    u64 last_read_tick;
+} s_perf;
+
+static void perfInit() {
+    s_perf.apm = R_SUCCEEDED(apmInitialize());
+    if (!s_perf.apm)
+        TRACE("apm unavailable, clocks stay as they are");
+
+    // Reading clocks is optional, applications aren't always allowed to
+    static const PcvModuleId modules[PerfClock_Count] = { PcvModuleId_CpuBus, PcvModuleId_GPU, PcvModuleId_EMC };
+    if (hosversionAtLeast(8, 0, 0) && R_SUCCEEDED(clkrstInitialize())) {
+        s_perf.clkrst = true;
+        for (int clock = 0; clock < PerfClock_Count && s_perf.clkrst; clock++) {
+            if (R_FAILED(clkrstOpenSession(&s_perf.sessions[clock], modules[clock], 3))) {
+                for (int open = 0; open < clock; open++)
+                    clkrstCloseSession(&s_perf.sessions[open]);
+                clkrstExit();
+                s_perf.clkrst = false;
+            }
+        }
+    }
+    else if (!hosversionAtLeast(8, 0, 0)) {
+        s_perf.pcv = R_SUCCEEDED(pcvInitialize());
+    }
+    if (!s_perf.clkrst && !s_perf.pcv)
+        TRACE("clock rates unavailable");
+}
+
+static void perfExit() {
+    if (s_perf.clkrst) {
+        for (int clock = 0; clock < PerfClock_Count; clock++)
+            clkrstCloseSession(&s_perf.sessions[clock]);
+        clkrstExit();
+    }
+    if (s_perf.pcv)
+        pcvExit();
+    if (s_perf.apm)
+        apmExit();
+}
+
+// Sets the clocks for both operation modes, so docking keeps the profile.
+// Pacing and the instance budget are up to the caller.
+static void perfSetProfile(PerfProfile profile) {
+    const PerfProfileDesc& desc = s_perf_profiles[profile];
+    s_perf.profile = profile;
+    s_perf.last_read_tick = 0;
+    if (!s_perf.apm)
+        return;
+
+    Result rc = apmSetPerformanceConfiguration(ApmPerformanceMode_Normal, desc.handheld_configuration);
+    if (R_SUCCEEDED(rc))
+        rc = apmSetPerformanceConfiguration(ApmPerformanceMode_Boost, desc.docked_configuration);
+    if (R_FAILED(rc))
+        TRACE("perf %s: configuration rejected (0x%x)", desc.name, rc);
+    else
+        TRACE("perf %s: configuration 0x%08x / 0x%08x", desc.name, desc.handheld_configuration, desc.docked_configuration);
+}
+
+// Current rate in MHz, 0 when it can't be read
+static float perfClockMhz(PerfClock clock) {
+    static const PcvModule modules[PerfClock_Count] = { PcvModule_CpuBus, PcvModule_GPU, PcvModule_EMC };
+    u32 hz = 0;
+    if (s_perf.clkrst)
+        clkrstGetClockRate(&s_perf.sessions[clock], &hz);
+    else if (s_perf.pcv)
+        pcvGetClockRate(modules[clock], &hz);
+    return hz * 1e-6f;
+}
+
+// Once per frame; the clocks are sampled once a second, clock changes take a moment anyway
+static void perfUpdate() {
+    u64 now = armGetSystemTick();
+    if (s_perf.last_read_tick != 0 && now - s_perf.last_read_tick < armGetSystemTickFreq())
+        return;
+    s_perf.last_read_tick = now;
+    profilerSetClocks(s_perf_profiles[s_perf.profile].name, perfClockMhz(PerfClock_Cpu),
+                      perfClockMhz(PerfClock_Gpu), perfClockMhz(PerfClock_Emc));
+}
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef __PIPELINE_H_
+#define __PIPELINE_H_
+
+#include <atomic>
+
+#include <switch.h>
+
+// Triple buffer handing frame snapshots from the simulation thread to the
+// render thread without either side ever waiting on the other. The writer
+// fills its back slot and swaps it with the shared middle one on publish; the
+// reader swaps its front slot with the middle one whenever something new was
+// published. Only slot indices move, the snapshots themselves stay in place.
+
+#define PIPELINE_SLOTS 3
+#define PIPELINE_FRESH 0x4 // set in middle until the reader takes it
+
+struct PipelineSlots {
+    std::atomic<u32> middle;
+    u32 back;  // owned by the writer
+    u32 front; // owned by the reader
+};
+
+static void pipelineInit(PipelineSlots* slots) {
+    slots->front = 0;
+    slots->middle.store(1, std::memory_order_relaxed);
+    slots->back = 2;
+}
+
+// Makes the back slot the latest snapshot and gives the writer a free one
+static void pipelinePublish(PipelineSlots* slots) {
+    u32 previous = slots->middle.exchange(slots->back | PIPELINE_FRESH, std::memory_order_acq_rel);
+    slots->back = previous & ~PIPELINE_FRESH;
+}
+
+// Moves front to the latest snapshot, false when nothing was published since the last call
+static bool pipelineAcquire(PipelineSlots* slots) {
+    if (!(slots->middle.load(std::memory_order_relaxed) & PIPELINE_FRESH))
+        return false;
+    u32 previous = slots->middle.exchange(slots->front, std::memory_order_acq_rel);
+    slots->front = previous & ~PIPELINE_FRESH;
+    return true;
+}
+
+#endif
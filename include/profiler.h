@@ -0,0 +1,405 @@
+#ifndef __PROFILER_H_
+#define __PROFILER_H_
+
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+
+#include <switch.h>
+#include <glad/glad.h>
+
+#include <arena.h>
+
+// Frame profiler: CPU zones are timed with armGetSystemTick, GPU zones with
+// GL_TIME_ELAPSED queries plus a GL_TIMESTAMP pair around the whole frame.
+// Samples go into per-series ring buffers and are summarized over nxlink as
+// min/avg/p99 once a second, never per frame. Reports go through TRACE, so
+// include nxlink.h first.
+//
+// Input latency is measured from the tick the frame's input was sampled at to
+// the frame's end timestamp, mapped from the GPU clock onto the CPU clock. Scanout
+// adds up to one more refresh on top, which no query can see.
+//
+// Job system workers add the time they spend in jobs to their core, which is
+// reported per frame next to the share of the frame time it amounts to.
+//
+// The report also carries the active performance profile and clocks, and how
+// many frames went over the pacing budget, to tell which clocks still hold it,
+// and the app's heap allocations counted in frames after the warm-up, which
+// should stay at zero, next to the frame arena's peak use.
+
+enum ProfileCpuZone {
+    ProfileCpu_Input,  // pad reads on the render thread
+    ProfileCpu_Latch,  // late-latched pad read right before rendering
+    ProfileCpu_Sim,    // one simulation frame, including the CPU reveal, timed wherever it ran
+    ProfileCpu_Render, // GL command submission for the frame
+    ProfileCpu_Hud,    // HUD text and its draw, only while it's shown
+    ProfileCpu_Pace,   // frame limiter sleep
+    ProfileCpu_Swap,
+    ProfileCpu_Frame,  // whole loop iteration
+    ProfileCpu_Count
+};
+
+// Zones before ProfileGpu_Frame are timed with a GL_TIME_ELAPSED query each,
+// the rest come from the frame's timestamp pair and have no query of their own
+enum ProfileGpuZone {
+    ProfileGpu_Upload,
+    ProfileGpu_Reveal,  // compute pass of the GPU reveal
+    ProfileGpu_Fill,
+    ProfileGpu_Line,
+    ProfileGpu_Upscale, // offscreen target blitted to the window
+    ProfileGpu_Hud,
+    ProfileGpu_Frame,  // from the first to the last command of the frame
+    ProfileGpu_InputLatency, // input sample to the GPU finishing the frame that shows it
+    ProfileGpu_Count,
+    ProfileGpu_ElapsedCount = ProfileGpu_Frame
+};
+
+static const char* const s_profile_cpu_names[ProfileCpu_Count] = { "cpu.input", "cpu.latch", "cpu.sim", "cpu.render", "cpu.hud", "cpu.pace", "cpu.swap", "cpu.frame" };
+static const char* const s_profile_gpu_names[ProfileGpu_Count] = { "gpu.upload", "gpu.reveal", "gpu.fill", "gpu.line", "gpu.upscale", "gpu.hud", "gpu.frame", "lat.input" };
+
+// Cores the job system runs on, 0 being the render thread's
+#define PROFILER_CORES 3
+static const char* const s_profile_core_names[PROFILER_CORES] = { "jobs.core0", "jobs.core1", "jobs.core2" };
+
+// Enough for a full second even when running uncapped at a few hundred fps
+#define PROFILER_HISTORY 512
+// GPU results are read back this many frames later so the CPU never waits on them
+#define PROFILER_GPU_LATENCY 3
+// Lifetime histogram used for whole-run results (benchmark mode), the last bucket collects overflow
+#define PROFILER_HISTOGRAM_BUCKETS 401
+#define PROFILER_HISTOGRAM_BUCKET_MS 0.1f
+// A frame counts as over budget past this much of the pacing budget, vsync jitter stays below
+#define PROFILER_BUDGET_SLACK 1.2f
+
+// Every sample ever pushed to a series, until profilerResetTotals()
+struct ProfileTotals {
+    u32 samples;
+    double sum;
+    float min, max;
+    u32 histogram[PROFILER_HISTOGRAM_BUCKETS];
+};
+
+struct ProfileSeries {
+    float samples[PROFILER_HISTORY]; // milliseconds
+    u32 count;   // total samples pushed
+    u32 flushed; // count at the last report
+    ProfileTotals totals;
+};
+
+struct ProfileStats {
+    u32 samples;
+    float min, avg, p99;
+};
+
+static struct {
+    ProfileSeries cpu[ProfileCpu_Count];
+    ProfileSeries gpu[ProfileGpu_Count];
+    ProfileSeries cores[PROFILER_CORES];
+    u64 cpu_begin[ProfileCpu_Count];
+    std::atomic<u64> core_busy_ticks[PROFILER_CORES]; // this frame so far, added to from any thread
+
+    // One set of queries per in-flight frame. The frame zone and input latency
+    // use the timestamp pair, the other zones a GL_TIME_ELAPSED query each.
+    GLuint elapsed_queries[PROFILER_GPU_LATENCY][ProfileGpu_ElapsedCount];
+    GLuint timestamp_queries[PROFILER_GPU_LATENCY][2];
+    bool gpu_issued[PROFILER_GPU_LATENCY][ProfileGpu_Frame + 1];
+
+    u64 input_tick[PROFILER_GPU_LATENCY]; // 0 when the frame had no input mark
+    s64 gpu_to_cpu_ns; // added to a GL timestamp to get armTicksToNs time
+
+    const char* perf_name; // null until clocks are set
+    float clock_mhz[3];    // CPU, GPU, EMC, 0 when unknown
+    float budget_ms;
+    u32 frames_over_budget; // since the last report
+    u32 frames_reported;
+
+    u32 heap_allocations;       // since the last report
+    u32 heap_allocations_total; // until profilerResetTotals()
+
+    u64 frame;
+    u64 last_report_tick;
+} s_profiler;
+
+static inline float profilerTicksToMs(u64 ticks) {
+    return armTicksToNs(ticks) * 1e-6f;
+}
+
+static void profileSeriesPush(ProfileSeries* series, float ms) {
+    series->samples[series->count % PROFILER_HISTORY] = ms;
+    series->count++;
+
+    ProfileTotals* totals = &series->totals;
+    if (totals->samples == 0 || ms < totals->min)
+        totals->min = ms;
+    if (totals->samples == 0 || ms > totals->max)
+        totals->max = ms;
+    totals->samples++;
+    totals->sum += ms;
+    int bucket = (int)(ms / PROFILER_HISTOGRAM_BUCKET_MS);
+    totals->histogram[bucket < PROFILER_HISTOGRAM_BUCKETS - 1 ? bucket : PROFILER_HISTOGRAM_BUCKETS - 1]++;
+}
+
+// Upper edge of the histogram bucket holding the given fraction of samples
+static float profileTotalsPercentile(const ProfileTotals* totals, float fraction) {
+    u32 target = (u32)(totals->samples * fraction);
+    u32 seen = 0;
+    for (int bucket = 0; bucket < PROFILER_HISTOGRAM_BUCKETS - 1; bucket++) {
+        seen += totals->histogram[bucket];
+        if (seen > target)
+            return (bucket + 1) * PROFILER_HISTOGRAM_BUCKET_MS;
+    }
+    return totals->max;
+}
+
+
+static int profilerCompareFloat(const void* a, const void* b) {
+    float fa = *(const float*)a, fb = *(const float*)b;
+    return (fa > fb) - (fa < fb);
+}
+
+// Summarizes the samples pushed since the last report
+static ProfileStats profileSeriesStats(const ProfileSeries* series, float* scratch) {
+    ProfileStats stats = { 0, 0.0f, 0.0f, 0.0f };
+    u32 n = series->count - series->flushed;
+    if (n > PROFILER_HISTORY)
+        n = PROFILER_HISTORY;
+    if (n == 0)
+        return stats;
+
+    float sum = 0.0f;
+    for (u32 i = 0; i < n; i++) {
+        scratch[i] = series->samples[(series->count - 1 - i) % PROFILER_HISTORY];
+        sum += scratch[i];
+    }
+    qsort(scratch, n, sizeof(float), profilerCompareFloat);
+
+    stats.samples = n;
+    stats.min = scratch[0];
+    stats.avg = sum / n;
+    stats.p99 = scratch[(n * 99) / 100];
+    return stats;
+}
+
+// Both clocks drift apart slowly, so this is redone with every report
+static void profilerCalibrateClocks() {
+    GLint64 gpu_now;
+    glGetInteger64v(GL_TIMESTAMP, &gpu_now);
+    s_profiler.gpu_to_cpu_ns = (s64)armTicksToNs(armGetSystemTick()) - gpu_now;
+}
+
+static void profilerInit() {
+    glGenQueries(PROFILER_GPU_LATENCY * ProfileGpu_ElapsedCount, &s_profiler.elapsed_queries[0][0]);
+    glGenQueries(PROFILER_GPU_LATENCY * 2, &s_profiler.timestamp_queries[0][0]);
+    s_profiler.last_report_tick = armGetSystemTick();
+    profilerCalibrateClocks();
+}
+
+// Records when the input this frame displays was sampled
+static inline void profilerMarkInput(u64 tick) {
+    s_profiler.input_tick[s_profiler.frame % PROFILER_GPU_LATENCY] = tick;
+}
+
+static void profilerExit() {
+    glDeleteQueries(PROFILER_GPU_LATENCY * 2, &s_profiler.timestamp_queries[0][0]);
+    glDeleteQueries(PROFILER_GPU_LATENCY * ProfileGpu_ElapsedCount, &s_profiler.elapsed_queries[0][0]);
+}
+
+static inline void profilerCpuBegin(ProfileCpuZone zone) {
+    s_profiler.cpu_begin[zone] = armGetSystemTick();
+}
+
+static inline void profilerCpuEnd(ProfileCpuZone zone) {
+    profileSeriesPush(&s_profiler.cpu[zone], profilerTicksToMs(armGetSystemTick() - s_profiler.cpu_begin[zone]));
+}
+
+static void profilerSetClocks(const char* perf_name, float cpu_mhz, float gpu_mhz, float emc_mhz) {
+    s_profiler.perf_name = perf_name;
+    s_profiler.clock_mhz[0] = cpu_mhz;
+    s_profiler.clock_mhz[1] = gpu_mhz;
+    s_profiler.clock_mhz[2] = emc_mhz;
+}
+
+// Frame time the pacing mode aims for, once per frame
+static inline void profilerSetFrameBudget(float ms) {
+    s_profiler.budget_ms = ms;
+}
+
+// Job time spent on a core, safe to call from any thread
+static inline void profilerCoreBusy(int core, u64 ticks) {
+    s_profiler.core_busy_ticks[core].fetch_add(ticks, std::memory_order_relaxed);
+}
+
+// Heap allocations made during a frame after the warm-up
+static inline void profilerCountAllocations(u32 count) {
+    s_profiler.heap_allocations += count;
+    s_profiler.heap_allocations_total += count;
+}
+
+// For work timed on another thread, which hands the duration over
+static inline void profilerCpuSample(ProfileCpuZone zone, float ms) {
+    profileSeriesPush(&s_profiler.cpu[zone], ms);
+}
+
+// GPU zones must not overlap, GL only allows one GL_TIME_ELAPSED query at a time.
+// Only zones below ProfileGpu_ElapsedCount can be timed this way.
+static inline void profilerGpuBegin(ProfileGpuZone zone) {
+    glBeginQuery(GL_TIME_ELAPSED, s_profiler.elapsed_queries[s_profiler.frame % PROFILER_GPU_LATENCY][zone]);
+}
+
+static inline void profilerGpuEnd(ProfileGpuZone zone) {
+    glEndQuery(GL_TIME_ELAPSED);
+    s_profiler.gpu_issued[s_profiler.frame % PROFILER_GPU_LATENCY][zone] = true;
+}
+
+// Collects the results of the frame that used this query slot. Results that
+// still aren't ready are dropped rather than stalling the pipeline.
+static void profilerCollectGpu(int slot) {
+    GLint available;
+    GLuint64 value;
+
+    for (int zone = 0; zone <= ProfileGpu_Frame; zone++) {
+        if (!s_profiler.gpu_issued[slot][zone])
+            continue;
+        s_profiler.gpu_issued[slot][zone] = false;
+
+        if (zone == ProfileGpu_Frame) {
+            GLuint64 begin, end;
+            glGetQueryObjectiv(s_profiler.timestamp_queries[slot][1], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+                continue;
+            glGetQueryObjectui64v(s_profiler.timestamp_queries[slot][0], GL_QUERY_RESULT, &begin);
+            glGetQueryObjectui64v(s_profiler.timestamp_queries[slot][1], GL_QUERY_RESULT, &end);
+            profileSeriesPush(&s_profiler.gpu[zone], (end - begin) * 1e-6f);
+
+            u64 input_tick = s_profiler.input_tick[slot];
+            s_profiler.input_tick[slot] = 0;
+            if (input_tick) {
+                s64 latency_ns = (s64)end + s_profiler.gpu_to_cpu_ns - (s64)armTicksToNs(input_tick);
+                if (latency_ns > 0)
+                    profileSeriesPush(&s_profiler.gpu[ProfileGpu_InputLatency], latency_ns * 1e-6f);
+            }
+            continue;
+        }
+
+        glGetQueryObjectiv(s_profiler.elapsed_queries[slot][zone], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+        glGetQueryObjectui64v(s_profiler.elapsed_queries[slot][zone], GL_QUERY_RESULT, &value);
+        profileSeriesPush(&s_profiler.gpu[zone], value * 1e-6f);
+    }
+}
+
+// Most recent sample of a GPU series, if one arrived since *seen was last updated
+static bool profilerLatestGpu(ProfileGpuZone zone, u32* seen, float* ms) {
+    const ProfileSeries* series = &s_profiler.gpu[zone];
+    if (series->count == *seen)
+        return false;
+    *seen = series->count;
+    *ms = series->samples[(series->count - 1) % PROFILER_HISTORY];
+    return true;
+}
+
+// Average of the latest samples of a series, for live displays; 0 without any
+static float profilerRecentMs(const ProfileSeries* series, u32 n) {
+    if (n > series->count)
+        n = series->count;
+    if (n > PROFILER_HISTORY)
+        n = PROFILER_HISTORY;
+    if (n == 0)
+        return 0.0f;
+    float sum = 0.0f;
+    for (u32 i = 0; i < n; i++)
+        sum += series->samples[(series->count - 1 - i) % PROFILER_HISTORY];
+    return sum / n;
+}
+
+static void profilerReport() {
+    if (s_profiler.perf_name)
+        TRACE("perf %s: cpu %.1f gpu %.1f emc %.1f MHz, %u/%u frames over %.2f ms", s_profiler.perf_name,
+              s_profiler.clock_mhz[0], s_profiler.clock_mhz[1], s_profiler.clock_mhz[2],
+              s_profiler.frames_over_budget, s_profiler.frames_reported, s_profiler.budget_ms);
+    s_profiler.frames_over_budget = 0;
+    s_profiler.frames_reported = 0;
+    TRACE("memory: %u heap allocations, frame arena peak %u/%u KiB, %u failed", s_profiler.heap_allocations,
+          (u32)(s_frame_arena.high_water / 1024), FRAME_ARENA_SIZE / 1024, s_frame_arena.failed);
+    s_profiler.heap_allocations = 0;
+
+    // Sorting space for the series, gone again when the report is done
+    size_t mark = arenaMark(&s_frame_arena);
+    float* scratch = arenaAllocArray<float>(&s_frame_arena, PROFILER_HISTORY);
+    if (!scratch)
+        return;
+
+    float frame_avg = 0.0f;
+    for (int zone = 0; zone < ProfileCpu_Count; zone++) {
+        ProfileSeries* series = &s_profiler.cpu[zone];
+        ProfileStats stats = profileSeriesStats(series, scratch);
+        series->flushed = series->count;
+        if (zone == ProfileCpu_Frame)
+            frame_avg = stats.avg;
+        if (stats.samples)
+            TRACE("%-10s min %6.3f avg %6.3f p99 %6.3f ms (%u)", s_profile_cpu_names[zone], stats.min, stats.avg, stats.p99, stats.samples);
+    }
+    for (int core = 0; core < PROFILER_CORES; core++) {
+        ProfileSeries* series = &s_profiler.cores[core];
+        ProfileStats stats = profileSeriesStats(series, scratch);
+        series->flushed = series->count;
+        if (stats.samples && stats.avg > 0.0f)
+            TRACE("%-10s min %6.3f avg %6.3f p99 %6.3f ms, %3.0f%% busy", s_profile_core_names[core], stats.min, stats.avg, stats.p99,
+                  frame_avg > 0.0f ? stats.avg / frame_avg * 100.0f : 0.0f);
+    }
+    for (int zone = 0; zone < ProfileGpu_Count; zone++) {
+        ProfileSeries* series = &s_profiler.gpu[zone];
+        ProfileStats stats = profileSeriesStats(series, scratch);
+        series->flushed = series->count;
+        if (stats.samples)
+            TRACE("%-10s min %6.3f avg %6.3f p99 %6.3f ms (%u)", s_profile_gpu_names[zone], stats.min, stats.avg, stats.p99, stats.samples);
+    }
+    arenaRewind(&s_frame_arena, mark);
+}
+
+static void profilerResetTotals() {
+    s_profiler.heap_allocations_total = 0;
+    for (int zone = 0; zone < ProfileCpu_Count; zone++)
+        memset(&s_profiler.cpu[zone].totals, 0, sizeof(ProfileTotals));
+    for (int zone = 0; zone < ProfileGpu_Count; zone++)
+        memset(&s_profiler.gpu[zone].totals, 0, sizeof(ProfileTotals));
+    for (int core = 0; core < PROFILER_CORES; core++)
+        memset(&s_profiler.cores[core].totals, 0, sizeof(ProfileTotals));
+}
+
+static void profilerBeginFrame() {
+    int slot = s_profiler.frame % PROFILER_GPU_LATENCY;
+    profilerCollectGpu(slot);
+
+    profilerCpuBegin(ProfileCpu_Frame);
+    glQueryCounter(s_profiler.timestamp_queries[slot][0], GL_TIMESTAMP);
+}
+
+// Call before eglSwapBuffers so the frame timestamp covers only this frame's commands
+static void profilerEndGpuFrame() {
+    int slot = s_profiler.frame % PROFILER_GPU_LATENCY;
+    glQueryCounter(s_profiler.timestamp_queries[slot][1], GL_TIMESTAMP);
+    s_profiler.gpu_issued[slot][ProfileGpu_Frame] = true;
+}
+
+static void profilerEndFrame() {
+    profilerCpuEnd(ProfileCpu_Frame);
+    const ProfileSeries* frame = &s_profiler.cpu[ProfileCpu_Frame];
+    if (frame->samples[(frame->count - 1) % PROFILER_HISTORY] > s_profiler.budget_ms * PROFILER_BUDGET_SLACK)
+        s_profiler.frames_over_budget++;
+    s_profiler.frames_reported++;
+    for (int core = 0; core < PROFILER_CORES; core++)
+        profileSeriesPush(&s_profiler.cores[core], profilerTicksToMs(s_profiler.core_busy_ticks[core].exchange(0, std::memory_order_relaxed)));
+    s_profiler.frame++;
+
+    u64 now = armGetSystemTick();
+    if (now - s_profiler.last_report_tick >= armGetSystemTickFreq()) {
+        profilerReport();
+        profilerCalibrateClocks();
+        s_profiler.last_report_tick = now;
+    }
+}
+
+#endif
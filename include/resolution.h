@@ -0,0 +1,244 @@
+#ifndef __RESOLUTION_H_
+#define __RESOLUTION_H_
+
+#include <math.h>
+
+#include <switch.h>
+#include <glad/glad.h>
+
+#include <profiler.h>
+#include <framebuffer.h>
+
+// Dynamic resolution: the scene renders into the lower left corner of an
+// offscreen target the size of the window, and that corner is blitted up to the
+// window. The render scale follows the GPU frame time from the profiler, so a
+// heavy scene drops resolution instead of frames. With the scaler disabled the
+// scene draws straight into the window and there is no blit at all.
+// The offscreen target carries the framebuffer profile's depth and MSAA
+// attachments; multisampled frames are resolved at render size before scaling.
+// Attachments that aren't needed after the frame are invalidated.
+// Reports go through TRACE, so include nxlink.h first.
+
+#define RESOLUTION_SCALE_STEP_UP 0.05f
+#define RESOLUTION_SCALE_MAX_STEP_DOWN 0.85f // never shrink by more than this factor at once
+#define RESOLUTION_HIGH_WATER 0.90f          // fraction of the frame budget that triggers a drop
+#define RESOLUTION_LOW_WATER 0.70f           // fraction below which resolution goes back up
+#define RESOLUTION_SETTLE_FRAMES 15          // frames ignored after a change, GPU results lag behind
+#define RESOLUTION_ALIGN 8
+
+static struct {
+    bool dynamic;
+    float min_scale;
+    float scale;
+    int window_width, window_height;
+    int render_width, render_height;
+
+    int depth_bits;
+    int samples;
+
+    GLuint fbo;
+    GLuint color_rbo;
+    GLuint depth_rbo;
+    GLuint resolve_fbo; // single-sample copy to scale from, MSAA only
+    GLuint resolve_rbo;
+
+    float gpu_ms; // smoothed gpu.frame at the current scale, 0 until the first sample
+    u32 gpu_seen;
+    int settle;
+} s_resolution;
+
+// Output size the system expects for the given operation mode
+static void resolutionWindowSize(AppletOperationMode mode, int* width, int* height) {
+    if (mode == AppletOperationMode_Console) {
+        *width = 1920;
+        *height = 1080;
+    }
+    else {
+        *width = 1280;
+        *height = 720;
+    }
+}
+
+static int resolutionAlign(float size, int max) {
+    int aligned = ((int)size + RESOLUTION_ALIGN - 1) / RESOLUTION_ALIGN * RESOLUTION_ALIGN;
+    return aligned > max ? max : aligned;
+}
+
+static void resolutionApplyScale(float scale) {
+    if (scale < s_resolution.min_scale)
+        scale = s_resolution.min_scale;
+    if (scale > 1.0f)
+        scale = 1.0f;
+    s_resolution.scale = scale;
+    s_resolution.render_width = resolutionAlign(s_resolution.window_width * scale, s_resolution.window_width);
+    s_resolution.render_height = resolutionAlign(s_resolution.window_height * scale, s_resolution.window_height);
+    s_resolution.gpu_ms = 0.0f;
+    s_resolution.settle = RESOLUTION_SETTLE_FRAMES;
+}
+
+static void resolutionDestroyTargets() {
+    GLuint framebuffers[] = { s_resolution.fbo, s_resolution.resolve_fbo };
+    GLuint renderbuffers[] = { s_resolution.color_rbo, s_resolution.depth_rbo, s_resolution.resolve_rbo };
+    glDeleteFramebuffers(2, framebuffers);
+    glDeleteRenderbuffers(3, renderbuffers);
+    s_resolution.fbo = s_resolution.resolve_fbo = 0;
+    s_resolution.color_rbo = s_resolution.depth_rbo = s_resolution.resolve_rbo = 0;
+}
+
+static GLuint resolutionCreateRenderbuffer(GLenum format, int samples, int width, int height) {
+    GLuint rbo;
+    glGenRenderbuffers(1, &rbo);
+    glBindRenderbuffer(GL_RENDERBUFFER, rbo);
+    if (samples > 1)
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples, format, width, height);
+    else
+        glRenderbufferStorage(GL_RENDERBUFFER, format, width, height);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    return rbo;
+}
+
+static bool resolutionCreateTargets(int width, int height) {
+    s_resolution.color_rbo = resolutionCreateRenderbuffer(GL_RGBA8, s_resolution.samples, width, height);
+    glGenFramebuffers(1, &s_resolution.fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, s_resolution.fbo);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, s_resolution.color_rbo);
+    if (s_resolution.depth_bits) {
+        s_resolution.depth_rbo = resolutionCreateRenderbuffer(GL_DEPTH_COMPONENT24, s_resolution.samples, width, height);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, s_resolution.depth_rbo);
+    }
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+    if (status == GL_FRAMEBUFFER_COMPLETE && s_resolution.samples > 1) {
+        s_resolution.resolve_rbo = resolutionCreateRenderbuffer(GL_RGBA8, 1, width, height);
+        glGenFramebuffers(1, &s_resolution.resolve_fbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, s_resolution.resolve_fbo);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, s_resolution.resolve_rbo);
+        status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        TRACE("offscreen target incomplete: 0x%x", status);
+        resolutionDestroyTargets();
+        return false;
+    }
+    return true;
+}
+
+// Call whenever the window changes size; the offscreen target is reallocated
+// once here and every later scale change only moves the viewport
+static void resolutionSetWindowSize(int width, int height) {
+    s_resolution.window_width = width;
+    s_resolution.window_height = height;
+    resolutionApplyScale(1.0f);
+
+    if (!s_resolution.dynamic)
+        return;
+
+    resolutionDestroyTargets();
+    if (!resolutionCreateTargets(width, height)) {
+        // Without the offscreen target the scene draws into the color-only window
+        TRACE("rendering at window size without depth or MSAA");
+        s_resolution.dynamic = false;
+        s_resolution.depth_bits = 0;
+        s_resolution.samples = 1;
+        return;
+    }
+    TRACE("window %dx%d", width, height);
+}
+
+// profile applies to whichever target the scene renders into: the offscreen
+// one when dynamic, otherwise the window, whose EGL config must match it
+static void resolutionInit(bool dynamic, float min_scale, int width, int height, const FramebufferProfileDesc* profile) {
+    s_resolution.dynamic = dynamic;
+    s_resolution.min_scale = min_scale > 0.25f ? min_scale : 0.25f;
+    s_resolution.depth_bits = profile->depth_bits;
+    s_resolution.samples = profile->samples;
+    resolutionSetWindowSize(width, height);
+}
+
+// Whether the scene's target has a depth buffer to test against
+static bool resolutionHasDepth() {
+    return s_resolution.depth_bits > 0;
+}
+
+static void resolutionExit() {
+    resolutionDestroyTargets();
+}
+
+// Once per frame, before rendering. budget_ms is the frame time the pacing mode aims for.
+static void resolutionUpdate(float budget_ms) {
+    float latest;
+    if (!profilerLatestGpu(ProfileGpu_Frame, &s_resolution.gpu_seen, &latest) || !s_resolution.dynamic)
+        return;
+    if (s_resolution.settle > 0) {
+        // Still measuring frames rendered at the previous scale
+        s_resolution.settle--;
+        return;
+    }
+    s_resolution.gpu_ms = s_resolution.gpu_ms == 0.0f ? latest : s_resolution.gpu_ms * 0.9f + latest * 0.1f;
+
+    float scale = s_resolution.scale;
+    if (s_resolution.gpu_ms > budget_ms * RESOLUTION_HIGH_WATER && scale > s_resolution.min_scale) {
+        // Pixel cost goes with the area, so shrink each axis by the square root of the overshoot
+        float step = sqrtf(budget_ms * RESOLUTION_LOW_WATER / s_resolution.gpu_ms);
+        scale *= step > RESOLUTION_SCALE_MAX_STEP_DOWN ? step : RESOLUTION_SCALE_MAX_STEP_DOWN;
+    }
+    else if (s_resolution.gpu_ms < budget_ms * RESOLUTION_LOW_WATER && scale < 1.0f) {
+        scale += RESOLUTION_SCALE_STEP_UP;
+    }
+    else {
+        return;
+    }
+
+    resolutionApplyScale(scale);
+    TRACE("render %dx%d (%.0f%%)", s_resolution.render_width, s_resolution.render_height, s_resolution.scale * 100.0f);
+}
+
+// Binds the target the scene renders into
+static void resolutionBeginFrame() {
+    glBindFramebuffer(GL_FRAMEBUFFER, s_resolution.fbo);
+    glViewport(0, 0, s_resolution.render_width, s_resolution.render_height);
+}
+
+// Scales the rendered corner up to the window, call before the swap
+static void resolutionEndFrame() {
+    if (!s_resolution.fbo) {
+        // Depth is dead once the frame is drawn, don't let it be written back
+        if (s_resolution.depth_bits) {
+            const GLenum depth = GL_DEPTH;
+            glInvalidateFramebuffer(GL_FRAMEBUFFER, 1, &depth);
+        }
+        return;
+    }
+
+    profilerGpuBegin(ProfileGpu_Upscale);
+    const int rw = s_resolution.render_width, rh = s_resolution.render_height;
+    const int ww = s_resolution.window_width, wh = s_resolution.window_height;
+    bool native = rw == ww && rh == wh;
+
+    GLuint source = s_resolution.fbo;
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, s_resolution.fbo);
+    if (s_resolution.samples > 1 && !native) {
+        // Multisampled blits can't scale, resolve at render size first
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, s_resolution.resolve_fbo);
+        glBlitFramebuffer(0, 0, rw, rh, 0, 0, rw, rh, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        source = s_resolution.resolve_fbo;
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, source);
+    }
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, rw, rh, 0, 0, ww, wh, GL_COLOR_BUFFER_BIT, native ? GL_NEAREST : GL_LINEAR);
+
+    // Nothing offscreen survives into the next frame, which clears it anyway
+    const GLenum attachments[] = { GL_COLOR_ATTACHMENT0, GL_DEPTH_ATTACHMENT };
+    if (source != s_resolution.fbo) {
+        glInvalidateFramebuffer(GL_READ_FRAMEBUFFER, 1, attachments);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, s_resolution.fbo);
+    }
+    glInvalidateFramebuffer(GL_READ_FRAMEBUFFER, s_resolution.depth_bits ? 2 : 1, attachments);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    profilerGpuEnd(ProfileGpu_Upscale);
+}
+
+#endif
@@ -0,0 +1,140 @@
+#ifndef __SHADER_CACHE_H_
+#define __SHADER_CACHE_H_
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <switch.h>
+#include <glad/glad.h>
+
+#include <config.h>
+#include <arena.h>
+
+// Program binary cache: linked programs are saved with glGetProgramBinary and
+// restored with glProgramBinary on later launches, skipping the GLSL compiler.
+// Entries are keyed by a hash of the shader sources and the driver strings, so
+// editing a shader or updating Mesa simply misses. A binary the driver rejects
+// is deleted and the caller falls back to compiling. Binaries are staged in
+// the frame arena, so the cache must only be used from the main thread.
+
+#define SHADER_CACHE_DIR CONFIG_DIR "/shadercache"
+#define SHADER_CACHE_MAGIC 0x42505352 // "RSPB"
+#define SHADER_CACHE_VERSION 1
+
+struct ShaderCacheHeader {
+    u32 magic;
+    u32 version;
+    u32 format;
+    u32 length;
+};
+
+static u64 shaderCacheHashBytes(u64 hash, const void* data, size_t size) {
+    // FNV-1a
+    const u8* bytes = (const u8*)data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+static u64 shaderCacheHashString(u64 hash, const char* s) {
+    // Include the terminator so ("ab", "c") and ("a", "bc") differ
+    return s ? shaderCacheHashBytes(hash, s, strlen(s) + 1) : shaderCacheHashBytes(hash, "", 1);
+}
+
+// Key for a program made of the given stages, gs may be null
+static u64 shaderCacheKey(const char* vs, const char* gs, const char* fs) {
+    u64 hash = 0xcbf29ce484222325ULL;
+    hash = shaderCacheHashString(hash, (const char*)glGetString(GL_VENDOR));
+    hash = shaderCacheHashString(hash, (const char*)glGetString(GL_RENDERER));
+    hash = shaderCacheHashString(hash, (const char*)glGetString(GL_VERSION));
+    hash = shaderCacheHashString(hash, vs);
+    hash = shaderCacheHashString(hash, gs);
+    hash = shaderCacheHashString(hash, fs);
+    return hash;
+}
+
+static bool shaderCacheSupported() {
+    GLint formats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+    return formats > 0;
+}
+
+static void shaderCachePath(char* path, size_t size, u64 key) {
+    snprintf(path, size, SHADER_CACHE_DIR "/%016llx.bin", (unsigned long long)key);
+}
+
+// Returns a linked program, or 0 when there is no usable entry
+static GLuint shaderCacheLoad(u64 key) {
+    char path[128];
+    shaderCachePath(path, sizeof(path), key);
+    FILE* f = fopen(path, "rb");
+    if (!f)
+        return 0;
+
+    ShaderCacheHeader header;
+    void* binary = nullptr;
+    size_t mark = arenaMark(&s_frame_arena);
+    bool ok = fread(&header, sizeof(header), 1, f) == 1 &&
+              header.magic == SHADER_CACHE_MAGIC && header.version == SHADER_CACHE_VERSION &&
+              (binary = arenaAlloc(&s_frame_arena, header.length)) != nullptr &&
+              fread(binary, header.length, 1, f) == 1;
+    fclose(f);
+
+    GLuint program = 0;
+    if (ok) {
+        program = glCreateProgram();
+        glProgramBinary(program, header.format, binary, header.length);
+        GLint success;
+        glGetProgramiv(program, GL_LINK_STATUS, &success);
+        if (!success) {
+            glDeleteProgram(program);
+            program = 0;
+        }
+    }
+    arenaRewind(&s_frame_arena, mark);
+
+    if (!program) {
+        TRACE("rejected %s", path);
+        remove(path);
+    }
+    return program;
+}
+
+// Call after a successful link of a program created with the retrievable hint
+static void shaderCacheStore(GLuint program, u64 key) {
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    size_t mark = arenaMark(&s_frame_arena);
+    void* binary = arenaAlloc(&s_frame_arena, length);
+    if (!binary) {
+        TRACE("program binary too large to cache (%d bytes)", length);
+        return;
+    }
+    ShaderCacheHeader header = { SHADER_CACHE_MAGIC, SHADER_CACHE_VERSION, 0, 0 };
+    GLsizei written = 0;
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &written, &format, binary);
+    header.format = format;
+    header.length = written;
+
+    char path[128];
+    shaderCachePath(path, sizeof(path), key);
+    mkdir(CONFIG_DIR, 0777);
+    mkdir(SHADER_CACHE_DIR, 0777);
+    FILE* f = written > 0 ? fopen(path, "wb") : nullptr;
+    if (f) {
+        bool ok = fwrite(&header, sizeof(header), 1, f) == 1 && fwrite(binary, written, 1, f) == 1;
+        fclose(f);
+        if (!ok)
+            remove(path);
+    }
+    arenaRewind(&s_frame_arena, mark);
+}
+
+#endif
@@ -1,242 +0,0 @@
-static Vertex sphere[] = {
-{{	0, -0.25, -0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.078262, -0.212664, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.029893, -0.212664, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.133148, -0.111805, 0.092002, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.078262, -0.212664, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.156524, -0.131434, -0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0, -0.25, -0, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.029893, -0.212664, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.096737, -0.212663, -0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0, -0.25, -0, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.096737, -0.212663, -0, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.029893, -0.212664, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0, -0.25, -0, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.029893, -0.212664, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.078262, -0.212664, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.133148, -0.111805, 0.092002, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.156524, -0.131434, -0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.175, -0, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.050857, -0.111805, 0.148864, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.048369, -0.131434, 0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	0, -0, 0.175, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.164579, -0.111804, -0, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.126631, -0.131434, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.175, -0, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.050857, -0.111805, -0.148864, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.126631, -0.131434, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.108156, 0, -0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.133148, -0.111805, -0.092002, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.048369, -0.131434, -0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.108156, 0, -0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.133148, -0.111805, 0.092002, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.175, -0, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.108156, -0, 0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.050857, -0.111805, 0.148864, }, { 0.0f, 0.0f, 0.0f }},
-{{	0, -0, 0.175, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.108156, -0, 0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.164579, -0.111804, -0, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.175, -0, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.175, 0, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.050857, -0.111805, -0.148864, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.108156, 0, -0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	0, 0, -0.175, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.133148, -0.111805, -0.092002, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.108156, 0, -0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.175, 0, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.050857, 0.111805, 0.148864, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.126631, 0.131434, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.029893, 0.212664, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.133148, 0.111805, 0.092002, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.048369, 0.131434, 0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.078262, 0.212664, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.133148, 0.111805, -0.092002, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.156524, 0.131434, 0, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.078262, 0.212664, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.050857, 0.111805, -0.148864, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.048369, 0.131434, -0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.029893, 0.212664, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.164579, 0.111804, 0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.126631, 0.131434, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.096737, 0.212663, 0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.096737, 0.212663, 0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.029893, 0.212664, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0, 0.25, 0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.096737, 0.212663, 0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.126631, 0.131434, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.029893, 0.212664, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.126631, 0.131434, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.050857, 0.111805, -0.148864, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.029893, 0.212664, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.029893, 0.212664, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.078262, 0.212664, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0, 0.25, 0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.029893, 0.212664, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.048369, 0.131434, -0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.078262, 0.212664, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.048369, 0.131434, -0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.133148, 0.111805, -0.092002, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.078262, 0.212664, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.078262, 0.212664, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.078262, 0.212664, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0, 0.25, 0, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.078262, 0.212664, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.156524, 0.131434, 0, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.078262, 0.212664, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.156524, 0.131434, 0, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.133148, 0.111805, 0.092002, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.078262, 0.212664, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.078262, 0.212664, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.029893, 0.212664, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0, 0.25, 0, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.078262, 0.212664, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.048369, 0.131434, 0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.029893, 0.212664, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.048369, 0.131434, 0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.050857, 0.111805, 0.148864, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.029893, 0.212664, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.029893, 0.212664, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.096737, 0.212663, 0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0, 0.25, 0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.029893, 0.212664, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.126631, 0.131434, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.096737, 0.212663, 0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.126631, 0.131434, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.164579, 0.111804, 0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.096737, 0.212663, 0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.175, 0, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.126631, 0.131434, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.164579, 0.111804, 0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.175, 0, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.108156, 0, -0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.126631, 0.131434, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.108156, 0, -0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.050857, 0.111805, -0.148864, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.126631, 0.131434, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0, 0, -0.175, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.048369, 0.131434, -0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.050857, 0.111805, -0.148864, }, { 0.0f, 0.0f, 0.0f }},
-{{	0, 0, -0.175, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.108156, 0, -0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.048369, 0.131434, -0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.108156, 0, -0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.133148, 0.111805, -0.092002, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.048369, 0.131434, -0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.175, 0, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.156524, 0.131434, 0, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.133148, 0.111805, -0.092002, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.175, 0, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.175, -0, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.156524, 0.131434, 0, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.175, -0, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.133148, 0.111805, 0.092002, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.156524, 0.131434, 0, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.108156, -0, 0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.048369, 0.131434, 0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.133148, 0.111805, 0.092002, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.108156, -0, 0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	0, -0, 0.175, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.048369, 0.131434, 0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	0, -0, 0.175, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.050857, 0.111805, 0.148864, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.048369, 0.131434, 0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.108156, -0, 0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.126631, 0.131434, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.050857, 0.111805, 0.148864, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.108156, -0, 0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.175, -0, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.126631, 0.131434, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.175, -0, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.164579, 0.111804, 0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.126631, 0.131434, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.108156, 0, -0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	0, 0, -0.175, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.050857, 0.111805, -0.148864, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.108156, 0, -0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.048369, -0.131434, -0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	0, 0, -0.175, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.048369, -0.131434, -0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.050857, -0.111805, -0.148864, }, { 0.0f, 0.0f, 0.0f }},
-{{	0, 0, -0.175, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.108156, 0, -0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.175, 0, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.133148, 0.111805, -0.092002, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.108156, 0, -0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.126631, -0.131434, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.175, 0, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.126631, -0.131434, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.164579, -0.111804, -0, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.175, 0, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.175, -0, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.108156, -0, 0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.133148, 0.111805, 0.092002, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.175, -0, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.126631, -0.131434, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.108156, -0, 0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.126631, -0.131434, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.050857, -0.111805, 0.148864, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.108156, -0, 0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	0, -0, 0.175, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.108156, -0, 0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.050857, 0.111805, 0.148864, }, { 0.0f, 0.0f, 0.0f }},
-{{	0, -0, 0.175, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.048369, -0.131434, 0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.108156, -0, 0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.048369, -0.131434, 0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.133148, -0.111805, 0.092002, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.108156, -0, 0.141578, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.175, -0, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.175, 0, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.164579, 0.111804, 0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.175, -0, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.156524, -0.131434, -0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.175, 0, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.156524, -0.131434, -0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.133148, -0.111805, -0.092002, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.175, 0, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.078262, -0.212664, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.048369, -0.131434, -0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.133148, -0.111805, -0.092002, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.078262, -0.212664, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.029893, -0.212664, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.048369, -0.131434, -0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.029893, -0.212664, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.050857, -0.111805, -0.148864, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.048369, -0.131434, -0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.029893, -0.212664, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.126631, -0.131434, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.050857, -0.111805, -0.148864, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.029893, -0.212664, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.096737, -0.212663, -0, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.126631, -0.131434, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.096737, -0.212663, -0, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.164579, -0.111804, -0, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.126631, -0.131434, -0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.096737, -0.212663, -0, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.126631, -0.131434, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.164579, -0.111804, -0, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.096737, -0.212663, -0, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.029893, -0.212664, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.126631, -0.131434, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.029893, -0.212664, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.050857, -0.111805, 0.148864, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.126631, -0.131434, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.156524, -0.131434, -0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.078262, -0.212664, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.133148, -0.111805, -0.092002, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.156524, -0.131434, -0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.078262, -0.212664, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.078262, -0.212664, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.078262, -0.212664, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0, -0.25, -0, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.078262, -0.212664, -0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.029893, -0.212664, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.048369, -0.131434, 0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.050857, -0.111805, 0.148864, }, { 0.0f, 0.0f, 0.0f }},
-{{	-0.029893, -0.212664, 0.087499, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.078262, -0.212664, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.048369, -0.131434, 0.141577, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.078262, -0.212664, 0.054077, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.133148, -0.111805, 0.092002, }, { 0.0f, 0.0f, 0.0f }},
-{{	0.048369, -0.131434, 0.141577, }, { 0.0f, 0.0f, 0.0f }},
-};
\ No newline at end of file
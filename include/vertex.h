@@ -1,11 +1,32 @@
-#ifndef __VERTEX_H_
-#define __VERTEX_H_
-
-#include <glm/vec3.hpp>
-
-struct Vertex {
-    glm::vec3 position;
-    glm::vec3 color;
-};
-
-#endif
\ No newline at end of file
+#ifndef __VERTEX_H_
+#define __VERTEX_H_
+
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+// Meshes are stored as a structure of arrays: each attribute lives in its own
+// buffer and is fed through its own binding point, so the immutable positions
+// never have to be touched when the reveal animates. The CPU reveal's colors
+// are a storage buffer in reveal order, looked up through the rank.
+enum VertexAttrib {
+    VertexAttrib_Position = 0,
+    VertexAttrib_RevealRank = 2,
+    VertexAttrib_InstanceOffsetScale = 3,
+    VertexAttrib_InstanceColor = 4,
+    VertexAttrib_InstanceClipOffset = 5,
+};
+
+enum VertexBinding {
+    VertexBinding_Position = 0,
+    VertexBinding_RevealRank = 2,
+    VertexBinding_Instance = 3, // divisor 1
+};
+
+// Per-instance attributes, interleaved in one buffer
+struct InstanceData {
+    glm::vec4 offset_scale; // xyz: world offset from the sphere translation, w: uniform scale
+    glm::vec4 clip_offset;  // the offset transformed by the camera, added after the shared MVP
+    glm::vec4 color;        // rgb: tint multiplied into the revealed color, a: slot in the GPU reveal state
+};
+
+#endif
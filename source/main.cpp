@@ -1,10 +1,10 @@
 //SPDX-License-Identifier: BSD-3-Clause
 //SPDX-FileCopyrightText: 2022 Lorenzo Cauli (lorecast162)
 
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <set>
 
 #include <switch.h>
 
@@ -19,10 +19,26 @@
 #include <glm/vec4.hpp>
 
 #include <vertex.h>
-#include <sphere.h>
+#include <mesh.h>
+#include <icosphere.h>
 
-#define ENABLE_NXLINK
+// ENABLE_NXLINK comes from the Makefile, release builds compile TRACE out
 #include <nxlink.h>
+#include <profiler.h>
+#include <pacing.h>
+#include <config.h>
+#include <bench.h>
+#include <shader_cache.h>
+#include <camera.h>
+#include <framebuffer.h>
+#include <resolution.h>
+#include <pipeline.h>
+#include <jobs.h>
+#include <perf.h>
+#include <hud.h>
+#include <arena.h>
+#include <alloc.h>
+#include <capture.h>
 
 //-----------------------------------------------------------------------------
 // EGL initialization
@@ -31,8 +47,9 @@
 static EGLDisplay s_display;
 static EGLContext s_context;
 static EGLSurface s_surface;
+static EGLConfig s_config;
 
-static bool initEgl(NWindow* win) {
+static bool initEgl(NWindow* win, FramebufferProfile profile, bool scene_in_window) {
     // Connect to the EGL default display
     s_display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
     if (!s_display) {
@@ -50,26 +67,17 @@ static bool initEgl(NWindow* win) {
     }
 
     // Get an appropriate EGL framebuffer configuration
-    EGLConfig config;
     EGLint numConfigs;
-    static const EGLint framebufferAttributeList[] = {
-        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
-        EGL_RED_SIZE, 8,
-        EGL_GREEN_SIZE, 8,
-        EGL_BLUE_SIZE, 8,
-        EGL_ALPHA_SIZE, 8,
-        EGL_DEPTH_SIZE, 24,
-        EGL_STENCIL_SIZE, 8,
-        EGL_NONE
-    };
-    eglChooseConfig(s_display, framebufferAttributeList, &config, 1, &numConfigs);
+    EGLint framebufferAttributeList[FRAMEBUFFER_MAX_EGL_ATTRIBUTES];
+    framebufferEglAttributes(profile, scene_in_window, framebufferAttributeList);
+    eglChooseConfig(s_display, framebufferAttributeList, &s_config, 1, &numConfigs);
     if (numConfigs == 0) {
         TRACE("No config found! error: %d", eglGetError());
         goto _fail1;
     }
 
     // Create an EGL window surface
-    s_surface = eglCreateWindowSurface(s_display, config, win, nullptr);
+    s_surface = eglCreateWindowSurface(s_display, s_config, win, nullptr);
     if (!s_surface) {
         TRACE("Surface creation failed! error: %d", eglGetError());
         goto _fail1;
@@ -82,7 +90,7 @@ static bool initEgl(NWindow* win) {
         EGL_CONTEXT_MINOR_VERSION_KHR, 3,
         EGL_NONE
     };
-    s_context = eglCreateContext(s_display, config, EGL_NO_CONTEXT, contextAttributeList);
+    s_context = eglCreateContext(s_display, s_config, EGL_NO_CONTEXT, contextAttributeList);
     if (!s_context) {
         TRACE("Context creation failed! error: %d", eglGetError());
         goto _fail2;
@@ -102,6 +110,22 @@ _fail0:
     return false;
 }
 
+// Recreates the window surface at a new size, e.g. 1080p when docked. The
+// window can only be resized while no surface holds its buffers.
+static bool resizeEglWindow(NWindow* win, int width, int height) {
+    eglMakeCurrent(s_display, EGL_NO_SURFACE, EGL_NO_SURFACE, s_context);
+    eglDestroySurface(s_display, s_surface);
+
+    nwindowSetDimensions(win, width, height);
+    s_surface = eglCreateWindowSurface(s_display, s_config, win, nullptr);
+    if (!s_surface) {
+        TRACE("Surface creation failed! error: %d", eglGetError());
+        return false;
+    }
+    eglMakeCurrent(s_display, s_surface, s_surface, s_context);
+    return true;
+}
+
 static void deinitEgl() {
     if (s_display) {
         eglMakeCurrent(s_display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
@@ -123,8 +147,10 @@ static void deinitEgl() {
 //-----------------------------------------------------------------------------
 
 static void setMesaConfig() {
-    // Uncomment below to disable error checking and save CPU time (useful for production):
-    // setenv("MESA_NO_ERROR", "1", 1);
+    // Release builds disable error checking to save CPU time
+#ifdef BUILD_RELEASE
+    setenv("MESA_NO_ERROR", "1", 1);
+#endif
 
     // Uncomment below to enable Mesa logging:
     // setenv("EGL_LOG_LEVEL", "debug", 1);
@@ -137,36 +163,188 @@ static void setMesaConfig() {
     // setenv("NV50_PROG_CHIPSET", "0x120", 1);
 }
 
+// Per-frame state shared by every stage, std140 mirror of struct FrameUniforms
+#define FRAME_UNIFORM_BLOCK                                                                  \
+    "layout (std140) uniform FrameUniforms {\n"                                             \
+    "    mat4 mvp;\n"                                                                       \
+    "    vec4 baseColor;\n"                                                                 \
+    "    vec4 lineColor;\n"                                                                 \
+    "    vec4 revealFromColor;\n"                                                           \
+    "    vec4 revealToColor;\n"                                                             \
+    "    vec4 revealParams; // x: RevealCommand, y: 1 for the GPU reveal, z: line width in pixels, w: instance count\n" \
+    "    vec4 revealClock;  // x: now, y: reveal start, z: duration, w: spread of the sphere start times, in seconds\n" \
+    "};\n"
+
+// Per-instance state of the GPU reveal, std430 mirror of struct InstanceReveal.
+// The compute pass advances it, the vertex stage reads it by instance slot.
+// Sweeps that overlap share one rank order (see revealRestart), so a sphere is
+// at most three bands along it: toColor below the progress, then revealedColor
+// up to where the previous sweep stopped (state.z), then fromColor.
+#define REVEAL_STATE_BLOCK(access)                                                           \
+    "struct InstanceReveal {\n"                                                              \
+    "    vec4 fromColor;\n"                                                                  \
+    "    vec4 revealedColor;\n"                                                              \
+    "    vec4 toColor;\n"                                                                    \
+    "    vec4 queuedColor; // target of a restart waiting for the middle band to go\n"       \
+    "    vec4 state; // x: progress 0..1, y: start time in seconds, z: previous boundary, w: 1 with a queued restart\n" \
+    "};\n"                                                                                   \
+    "layout (std430, binding = 0) " access " buffer RevealState {\n"                         \
+    "    InstanceReveal reveal[];\n"                                                         \
+    "};\n"
+
 static const char* const vertexShaderSource = R"text(
-    #version 330 core
+    #version 430 core
+)text" FRAME_UNIFORM_BLOCK REVEAL_STATE_BLOCK("readonly") R"text(
+    // CPU reveal colors in reveal order, rgb per position
+    layout (std430, binding = 1) readonly buffer RevealColors {
+        float revealColors[];
+    };
 
     layout (location = 0) in vec3 aPos;
-    layout (location = 1) in vec3 aColor;
-
-    uniform mat4 transform;
-    uniform mat4 translation;
+    layout (location = 2) in float aRevealRank;
+    layout (location = 3) in vec4 iOffsetScale;
+    layout (location = 4) in vec4 iColor; // rgb: tint, a: reveal state slot
+    layout (location = 5) in vec4 iClipOffset;
 
     out vec3 ourColor;
 
     void main()
     {
-        gl_Position = translation * transform * vec4(aPos.x, aPos.y, aPos.z, 1.0);
-        ourColor = aColor;
+        // Each instance spins in place: the shared MVP rotates and projects, the
+        // instance offset is already in clip space so it is simply added
+        gl_Position = mvp * vec4(aPos * iOffsetScale.w, 1.0) + iClipOffset;
+        // GPU reveal: vertices whose rank is below the sphere's progress show its new color
+        if (revealParams.y != 0.0) {
+            InstanceReveal r = reveal[int(iColor.a)];
+            ourColor = aRevealRank < r.state.x ? r.toColor.rgb : aRevealRank < r.state.z ? r.revealedColor.rgb : r.fromColor.rgb;
+        }
+        else {
+            // The rank is this vertex's position in reveal order
+            int k = int(aRevealRank * float(revealColors.length() / 3) + 0.5) * 3;
+            ourColor = vec3(revealColors[k], revealColors[k + 1], revealColors[k + 2]);
+        }
+        ourColor *= iColor.rgb;
     }
 )text";
 
 static const char* const fragmentShaderSource = R"text(
     #version 330 core
-
+)text" FRAME_UNIFORM_BLOCK R"text(
     in vec3 ourColor;
 
     out vec4 fragColor;
 
-    uniform vec3 color;
+    void main()
+    {
+        fragColor = vec4(ourColor * baseColor.rgb, 1.0f);
+    }
+)text";
+
+// Second pass of the two-pass wireframe, drawn with GL_LINE
+static const char* const lineFragmentShaderSource = R"text(
+    #version 330 core
+)text" FRAME_UNIFORM_BLOCK R"text(
+    out vec4 fragColor;
+
+    void main()
+    {
+        fragColor = vec4(lineColor.rgb, 1.0f);
+    }
+)text";
+
+// Single-pass wireframe: the geometry shader tags each corner with a barycentric
+// coordinate so the fragment shader can find triangle edges and shade the outline
+// together with the fill, instead of a second GL_LINE pass over the whole mesh.
+static const char* const wireGeometryShaderSource = R"text(
+    #version 330 core
+
+    layout (triangles) in;
+    layout (triangle_strip, max_vertices = 3) out;
+
+    in vec3 ourColor[];
+
+    out vec3 wireColor;
+    noperspective out vec3 barycentric;
+
+    void main()
+    {
+        for (int i = 0; i < 3; i++) {
+            gl_Position = gl_in[i].gl_Position;
+            wireColor = ourColor[i];
+            barycentric = vec3(i == 0, i == 1, i == 2);
+            EmitVertex();
+        }
+        EndPrimitive();
+    }
+)text";
+
+static const char* const wireFragmentShaderSource = R"text(
+    #version 330 core
+)text" FRAME_UNIFORM_BLOCK R"text(
+    in vec3 wireColor;
+    noperspective in vec3 barycentric;
+
+    out vec4 fragColor;
+
+    void main()
+    {
+        // Distance to the closest edge in pixels, antialiased over one pixel
+        float lineWidth = revealParams.z;
+        vec3 d = fwidth(barycentric);
+        vec3 a = smoothstep(d * (lineWidth - 0.5), d * (lineWidth + 0.5), barycentric);
+        float edge = 1.0 - min(min(a.x, a.y), a.z);
+        fragColor = vec4(mix(wireColor * baseColor.rgb, lineColor.rgb, edge), 1.0f);
+    }
+)text";
+
+// GPU reveal, one invocation per sphere. Every sphere but the first starts a
+// little late, by a hash of its slot, so a color change ripples over the grid.
+static const char* const revealComputeShaderSource = R"text(
+    #version 430 core
+)text" FRAME_UNIFORM_BLOCK REVEAL_STATE_BLOCK("") R"text(
+    layout (local_size_x = 64) in;
 
     void main()
     {
-        fragColor = vec4(ourColor * color, 1.0f);
+        uint i = gl_GlobalInvocationID.x;
+        if (i >= uint(revealParams.w))
+            return;
+
+        InstanceReveal r = reveal[i];
+        float delay = float((i * 2654435761u) >> 16) / 65535.0 * revealClock.w;
+        if (revealParams.x == 1.0) {
+            // New target. Once the sweep is past the previous boundary there are
+            // only two bands, the revealed one becomes the middle band and every
+            // vertex sets off from the color it shows. Until then a fourth color
+            // would be needed, so the restart waits; a later one replaces it.
+            if (r.state.x >= r.state.z) {
+                r.revealedColor = r.toColor;
+                r.toColor = revealToColor;
+                r.state.y = revealClock.y + delay;
+                r.state.z = r.state.x;
+            }
+            else {
+                r.queuedColor = revealToColor;
+                r.state.w = 1.0;
+            }
+        }
+        else if (revealParams.x == 2.0) {
+            // Start over in step with the global reveal
+            r.fromColor = revealFromColor;
+            r.revealedColor = revealFromColor;
+            r.toColor = revealToColor;
+            r.state.y = revealClock.y + delay;
+            r.state.z = 0.0;
+            r.state.w = 0.0;
+        }
+        r.state.x = clamp((revealClock.x - r.state.y) / revealClock.z, 0.0, 1.0);
+        if (r.state.w != 0.0 && r.state.x >= r.state.z) {
+            // The middle band is gone, the queued restart sets off from here
+            r.revealedColor = r.toColor;
+            r.toColor = r.queuedColor;
+            r.state = vec4(0.0, revealClock.x, r.state.x, 0.0);
+        }
+        reveal[i] = r;
     }
 )text";
 
@@ -193,165 +371,1376 @@ static GLuint createAndCompileShader(GLenum type, const char* source) {
     return handle;
 }
 
-static GLuint s_program;
-static GLuint s_vao, s_vbo;
-static unsigned int transformation_uniform_loc;
-static unsigned int translation_uniform_loc;
-static unsigned int color_uniform_loc;
-static glm::mat4 transformation_matrix = glm::mat4(1.0f);
-static glm::mat4 translation_matrix = glm::mat4(1.0f);
+// Links a program from the given stages, gsh may be 0, and so may fsh when
+// the first one is a compute shader
+static GLuint createAndLinkProgram(GLuint vsh, GLuint gsh, GLuint fsh) {
+    GLuint program = glCreateProgram();
+    glAttachShader(program, vsh);
+    if (gsh)
+        glAttachShader(program, gsh);
+    if (fsh)
+        glAttachShader(program, fsh);
+    // Allow glGetProgramBinary so the result can go into the shader cache
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(program);
+
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (!success) {
+        char buf[512];
+        glGetProgramInfoLog(program, sizeof(buf), nullptr, buf);
+        TRACE("Link error: %s", buf);
+    }
+    return program;
+}
+
+// Loads a program from the binary cache, or compiles, links and caches it. gs may be null.
+static GLuint createCachedProgram(const char* vs, const char* gs, const char* fs) {
+    bool cache = shaderCacheSupported();
+    u64 key = shaderCacheKey(vs, gs, fs);
+    if (cache) {
+        GLuint program = shaderCacheLoad(key);
+        if (program)
+            return program;
+    }
+
+    GLuint vsh = createAndCompileShader(GL_VERTEX_SHADER, vs);
+    GLuint gsh = gs ? createAndCompileShader(GL_GEOMETRY_SHADER, gs) : 0;
+    GLuint fsh = createAndCompileShader(GL_FRAGMENT_SHADER, fs);
+    GLuint program = createAndLinkProgram(vsh, gsh, fsh);
+    glDeleteShader(vsh);
+    if (gsh)
+        glDeleteShader(gsh);
+    glDeleteShader(fsh);
+
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (cache && success)
+        shaderCacheStore(program, key);
+    return program;
+}
+
+// The same for a compute program
+static GLuint createCachedComputeProgram(const char* cs) {
+    bool cache = shaderCacheSupported();
+    u64 key = shaderCacheKey(cs, nullptr, nullptr);
+    if (cache) {
+        GLuint program = shaderCacheLoad(key);
+        if (program)
+            return program;
+    }
+
+    GLuint csh = createAndCompileShader(GL_COMPUTE_SHADER, cs);
+    GLuint program = createAndLinkProgram(csh, 0, 0);
+    glDeleteShader(csh);
+
+    GLint success;
+    glGetProgramiv(program, GL_LINK_STATUS, &success);
+    if (cache && success)
+        shaderCacheStore(program, key);
+    return program;
+}
+
+// Uniform block binding point of FrameUniforms
+#define FRAME_UNIFORMS_BINDING 0
+// Storage block binding point of RevealState, spelled out in REVEAL_STATE_BLOCK
+#define REVEAL_STATE_BINDING 0
+#define REVEAL_COLORS_BINDING 1
+#define REVEAL_GROUP_SIZE 64 // local_size_x of the reveal compute shader
+
+static void bindFrameUniformBlock(GLuint program) {
+    GLuint index = glGetUniformBlockIndex(program, "FrameUniforms");
+    if (index != GL_INVALID_INDEX)
+        glUniformBlockBinding(program, index, FRAME_UNIFORMS_BINDING);
+}
+
+// Layout glMultiDrawElementsIndirect reads
+struct DrawElementsIndirectCommand {
+    GLuint count;
+    GLuint instance_count;
+    GLuint first_index;
+    GLint base_vertex;
+    GLuint base_instance;
+};
+
+static GLuint s_program;      // fill pass
+static GLuint s_line_program; // line pass of the two-pass wireframe
+static GLuint s_wire_program; // single-pass fill + outline
+static GLuint s_reveal_program; // GPU reveal compute pass
+static GLuint s_reveal_ssbo;
+static GLuint s_vao, s_position_vbo, s_color_ssbo, s_rank_vbo, s_instance_vbo, s_ibo;
+static InstanceData* s_instance_map;
+static GLuint s_indirect_buffer;
+static DrawElementsIndirectCommand* s_indirect_map;
+
+// std140 layout, see FRAME_UNIFORM_BLOCK
+struct FrameUniforms {
+    glm::mat4 mvp;
+    glm::vec4 base_color;
+    glm::vec4 line_color;
+    glm::vec4 reveal_from_color;
+    glm::vec4 reveal_to_color;
+    glm::vec4 reveal_params;
+    glm::vec4 reveal_clock;
+};
+
+struct InstanceReveal {
+    glm::vec4 from_color;
+    glm::vec4 revealed_color;
+    glm::vec4 to_color;
+    glm::vec4 queued_color;
+    glm::vec4 state;
+};
+
+// Per-frame uniforms are written into a persistently mapped ring, one slice per
+// frame in flight; a fence per slice keeps the CPU from overwriting a slice the
+// GPU still reads.
+#define FRAME_UNIFORM_SLICES 3
+static GLuint s_frame_ubo;
+static u8* s_frame_ubo_map;
+static GLsizeiptr s_frame_ubo_stride;
+static GLsync s_frame_ubo_fences[FRAME_UNIFORM_SLICES];
+static int s_frame_ubo_slice = 0;
 static glm::vec3 color = glm::vec3(1.0f, 0.0f, 0.0f);
+static Camera s_camera;
 
 static glm::vec3 sphere_base_color = glm::vec3(1.0f, 1.0f, 1.0f);
 static glm::vec3 line_color = glm::vec3(0.0f);
-
-std::set<int> changed_indeces = {};
+static float line_width = 1.0f; // pixels, single-pass wireframe only
+
+enum WireframeMode {
+    WireframeMode_TwoPass,    // GL_FILL pass, then a GL_LINE pass
+    WireframeMode_SinglePass, // barycentric edges in one draw
+};
+static WireframeMode wireframe_mode = WireframeMode_SinglePass;
+
+#define SPHERE_RADIUS 0.25f
+#define SPHERE_VERTEX_TOTAL icosphereTotalVertexCount(ICOSPHERE_MAX_LEVEL)
+// Projected edge length the per-instance LOD selection aims for
+#define SPHERE_LOD_TARGET_EDGE_PX 12.0f
+
+// Immutable geometry for every LOD, generated and checked by the compiler into
+// .rodata and uploaded straight from there. Only the colors below are mutable.
+static constexpr IcosphereLods sphere_lods = icosphereBuildLods(SPHERE_RADIUS);
+static_assert(icosphereLodsValid(sphere_lods, SPHERE_RADIUS), "generated sphere LODs are malformed");
+static_assert(sizeof(MeshPosition) == sizeof(glm::vec3), "positions must match the GL vertex format");
+
+static int sphere_lod_override = -1; // forced level, -1 picks per instance
+
+// From here on, the scene state is owned by the simulation thread. The render
+// thread only ever sees it through FrameSnapshot copies. Every table carries a
+// generation, bumped on each change, that the copies and GL uploads follow.
+
+// Colors of the CPU reveal by position in reveal_order, mirrored into
+// s_color_ssbo. A step paints the run from the previous reveal_cursor on, so
+// within a generation only positions below the cursor ever change; the
+// generation is bumped when the whole table is rewritten.
+static glm::vec3 sphere_colors[SPHERE_VERTEX_TOTAL];
+static u32 sphere_colors_generation = 1;
+
+// Order in which the reveal recolors vertices, reshuffled on every color change.
+// It spans the vertices of all LODs, so each level reveals at the same pace.
+static int reveal_order[SPHERE_VERTEX_TOTAL];
+static int reveal_cursor = 0;
+
+enum RevealMode {
+    RevealMode_Cpu, // CPU recolors vertices and uploads them
+    RevealMode_Gpu, // vertex shader compares each vertex's rank against a progress uniform
+};
+static RevealMode reveal_mode = RevealMode_Gpu;
+
+// Position of each vertex in reveal_order over the vertex count, mirrored into
+// s_rank_vbo for the GPU reveal
+static float reveal_ranks[SPHERE_VERTEX_TOTAL];
+static u32 reveal_ranks_generation = 1;
+static float reveal_duration = 0.175f; // seconds for a full sweep, in both modes, from the config
+// Shortest accepted sweep, anything faster reads as a flash
+#define REVEAL_DURATION_MIN 0.01f
+static float reveal_progress = 0.0f;   // 0..1
+static u64 reveal_start_tick = 0;
+
+#define REVEAL_INSTANCE_SPREAD 0.25f // seconds between the first and the last sphere starting
+
+// Time the simulation has been brought up to: the system tick when playing
+// live, a fixed 60 Hz clock in benchmark mode
+static u64 sim_now = 0;
+static glm::vec3 reveal_from_color = glm::vec3(0.0f);
+
+// Instanced mode: every sphere shares the mesh and reveal, laid out on a grid
+#define MAX_INSTANCES 4096
+#define INSTANCE_BOB_CELLS 0.1f                // bob height relative to the grid cell
+#define INSTANCE_BOB_PERIOD_NS 2000000000ULL
+// Instances per culling job, and the segments that cuts the LOD ranges into at most
+#define INSTANCE_JOB_GRAIN 64
+#define INSTANCE_MAX_SEGMENTS (MAX_INSTANCES / INSTANCE_JOB_GRAIN + ICOSPHERE_LEVEL_COUNT)
+static InstanceData instances[MAX_INSTANCES];
+static int instance_count = 1;
+// instances[] is sorted by LOD, each level draws its own contiguous range
+static int lod_first_instance[ICOSPHERE_LEVEL_COUNT];
+static int lod_instance_count[ICOSPHERE_LEVEL_COUNT];
+static float instance_bob = 0.0f; // height each sphere bobs by, around its grid position
+static u32 instances_generation = 1;
+// Window height the LODs were picked for, and the one the render thread asks for
+static int sim_layout_height = 0;
+static std::atomic<int> s_layout_height(0);
+// Most instances the performance profile allows, set by the render thread
+static std::atomic<int> s_instance_budget(MAX_INSTANCES);
+
+// Fixed-timestep simulation: motion advances in SIM_HZ steps no matter how often
+// frames are rendered, and rendering interpolates between the last two steps.
+// 60 Hz keeps the original per-frame speeds at a 60 fps frame rate.
+#define SIM_HZ 60
+#define SIM_MAX_STEPS_PER_FRAME 8 // after a longer stall, time is dropped instead of caught up
+#define SIM_MOVE_PER_STEP 0.01f
+#define SIM_TURN_PER_STEP glm::radians(2.3f)
+#define SIM_STICK_DEADZONE 0.12f
+
+struct SimState {
+    float position_x;
+    float angle; // radians around Y
+};
+
+static SimState sim_prev = { 0.0f, 0.0f };
+static SimState sim_curr = { 0.0f, 0.0f };
+static u64 sim_tick = 0;      // time sim_curr corresponds to
+static u64 sim_step_ticks = 0;
 
 static bool is_changing_color = false;
 static int selected_color = 0; //0: red, 1: blue, 2: green
 static int prev_color = 0; //0: red, 1: blue, 2: green
 
-static void sceneInit() {
-    GLint vsh = createAndCompileShader(GL_VERTEX_SHADER, vertexShaderSource);
-    GLint fsh = createAndCompileShader(GL_FRAGMENT_SHADER, fragmentShaderSource);
+// The GPU reveal tells its bands apart by rank, so the order is only reshuffled
+// once every sphere is done: the last one starts REVEAL_INSTANCE_SPREAD late and
+// a queued restart can add a second sweep after its current one
+static bool revealSettled() {
+    return reveal_start_tick == 0 || sim_now - reveal_start_tick >= armNsToTicks((u64)((REVEAL_INSTANCE_SPREAD + 2.0f * reveal_duration) * 1e9f));
+}
 
-    s_program = glCreateProgram();
-    glAttachShader(s_program, vsh);
-    glAttachShader(s_program, fsh);
-    glLinkProgram(s_program);
+static void revealRestart(const glm::vec3& from_color) {
+    if (reveal_mode == RevealMode_Cpu || revealSettled()) {
+        // The CPU colors follow the order, each vertex keeps the one it shows
+        static glm::vec3 vertex_colors[SPHERE_VERTEX_TOTAL];
+        int n = SPHERE_VERTEX_TOTAL;
+        if (reveal_mode == RevealMode_Cpu)
+            for (int i = 0; i < n; i++)
+                vertex_colors[reveal_order[i]] = sphere_colors[i];
+
+        // Fisher-Yates shuffle of the vertex table, walked by reveal_cursor
+        for (int i = 0; i < n; i++)
+            reveal_order[i] = i;
+        for (int i = n - 1; i > 0; i--) {
+            int j = rand() % (i + 1);
+            int tmp = reveal_order[i];
+            reveal_order[i] = reveal_order[j];
+            reveal_order[j] = tmp;
+        }
+        for (int i = 0; i < n; i++)
+            reveal_ranks[reveal_order[i]] = (float)i / n;
+        reveal_ranks_generation++;
+
+        if (reveal_mode == RevealMode_Cpu) {
+            for (int i = 0; i < n; i++)
+                sphere_colors[i] = vertex_colors[reveal_order[i]];
+            sphere_colors_generation++;
+        }
+    }
 
-    GLint success;
-    glGetProgramiv(s_program, GL_LINK_STATUS, &success);
-    if (!success) {
-        char buf[512];
-        glGetProgramInfoLog(s_program, sizeof(buf), nullptr, buf);
-        TRACE("Link error: %s", buf);
+    reveal_from_color = from_color;
+    reveal_cursor = 0;
+    reveal_progress = 0.0f;
+    reveal_start_tick = sim_now;
+}
+
+// Vertices of reveal_order that are revealed at the given progress
+static int revealCursorFor(float progress) {
+    int cursor = (int)ceilf(progress * SPHERE_VERTEX_TOTAL);
+    return cursor > SPHERE_VERTEX_TOTAL ? SPHERE_VERTEX_TOTAL : cursor;
+}
+
+// Switching modes carries the current progress over so the sweep continues where it was
+static void revealSetMode(RevealMode mode) {
+    if (mode == reveal_mode)
+        return;
+
+    if (mode == RevealMode_Cpu) {
+        reveal_cursor = revealCursorFor(reveal_progress);
+        for (int i = 0; i < SPHERE_VERTEX_TOTAL; i++)
+            sphere_colors[i] = i < reveal_cursor ? color : reveal_from_color;
+        sphere_colors_generation++;
+    }
+    else {
+        reveal_start_tick = sim_now - armNsToTicks((u64)(reveal_progress * reveal_duration * 1e9f));
     }
-    glDeleteShader(vsh);
-    glDeleteShader(fsh);
 
-    transformation_uniform_loc = glGetUniformLocation(s_program, "transform");
-    translation_uniform_loc = glGetUniformLocation(s_program, "translation");
-    color_uniform_loc = glGetUniformLocation(s_program, "color");
+    reveal_mode = mode;
+}
+
+static int selectInstanceLod(const glm::vec3& offset, float scale) {
+    if (sphere_lod_override >= 0)
+        return sphere_lod_override > ICOSPHERE_MAX_LEVEL ? ICOSPHERE_MAX_LEVEL : sphere_lod_override;
+    float radius_px = cameraProjectedRadius(&s_camera, offset, SPHERE_RADIUS * scale, (float)sim_layout_height);
+    return icosphereLevelForRadius(radius_px, SPHERE_LOD_TARGET_EDGE_PX);
+}
+
+static void setInstanceCount(int count) {
+    if (count < 1)
+        count = 1;
+    if (count > s_instance_budget.load(std::memory_order_relaxed))
+        count = s_instance_budget.load(std::memory_order_relaxed);
+    if (count > MAX_INSTANCES)
+        count = MAX_INSTANCES;
+    sim_layout_height = s_layout_height.load(std::memory_order_acquire);
+
+    // Square grid over clip space; a single instance keeps the original size and position
+    int cols = (int)ceilf(sqrtf((float)count));
+    int rows = (count + cols - 1) / cols;
+    float cell = 2.0f / cols;
+    float scale = cell * 0.8f / (2.0f * SPHERE_RADIUS);
+    if (scale > 1.0f)
+        scale = 1.0f;
+
+    // Counting sort by LOD: first count each level, then place every instance in its range
+    static u8 instance_lods[MAX_INSTANCES];
+    memset(lod_instance_count, 0, sizeof(lod_instance_count));
+    for (int i = 0; i < count; i++) {
+        int x = i % cols, y = i / cols;
+        glm::vec3 offset = glm::vec3(cell * (x + 0.5f - cols * 0.5f), cell * (rows * 0.5f - y - 0.5f), 0.0f);
+        instance_lods[i] = (u8)selectInstanceLod(offset, scale);
+        lod_instance_count[instance_lods[i]]++;
+    }
+    int first = 0;
+    for (int lod = 0; lod < ICOSPHERE_LEVEL_COUNT; lod++) {
+        lod_first_instance[lod] = first;
+        first += lod_instance_count[lod];
+    }
+
+    int placed[ICOSPHERE_LEVEL_COUNT] = {};
+    for (int i = 0; i < count; i++) {
+        int x = i % cols, y = i / cols;
+        int lod = instance_lods[i];
+        InstanceData& inst = instances[lod_first_instance[lod] + placed[lod]++];
+        glm::vec3 offset = glm::vec3(cell * (x + 0.5f - cols * 0.5f), cell * (rows * 0.5f - y - 0.5f), 0.0f);
+        inst.offset_scale = glm::vec4(offset, scale);
+        inst.clip_offset = cameraClipOffset(&s_camera, offset);
+        // Cheap hash so neighbours get visibly different tints, the first one stays white
+        u32 h = i * 2654435761u;
+        inst.color = i == 0 ? glm::vec4(1.0f) : glm::vec4(0.5f + (h & 0xff) / 510.0f,
+                                                          0.5f + ((h >> 8) & 0xff) / 510.0f,
+                                                          0.5f + ((h >> 16) & 0xff) / 510.0f, 1.0f);
+    }
+
+    instance_bob = count == 1 ? 0.0f : cell * INSTANCE_BOB_CELLS;
+    instance_count = count;
+    instances_generation++;
+}
+
+// Table generations the GL buffers hold, render thread only
+static u32 drawn_instances_generation = 0;
+static u32 uploaded_ranks_generation = 0;
+static u32 uploaded_colors_generation = 0;
+static int uploaded_colors_end = 0;
+
+static void sceneUseProgram() {
+    glUseProgram(wireframe_mode == WireframeMode_SinglePass ? s_wire_program : s_program);
+}
+
+static void sceneInit() {
+    // The window is 1280x720 handheld and 1920x1080 docked, 16:9 either way
+    cameraInit(&s_camera, 1280.0f / 720.0f);
+
+    revealRestart(glm::vec3(0.0f));
+
+    u64 start = armGetSystemTick();
+    s_program = createCachedProgram(vertexShaderSource, nullptr, fragmentShaderSource);
+    s_line_program = createCachedProgram(vertexShaderSource, nullptr, lineFragmentShaderSource);
+    s_wire_program = createCachedProgram(vertexShaderSource, wireGeometryShaderSource, wireFragmentShaderSource);
+    bindFrameUniformBlock(s_program);
+    bindFrameUniformBlock(s_line_program);
+    bindFrameUniformBlock(s_wire_program);
+    s_reveal_program = createCachedComputeProgram(revealComputeShaderSource);
+    bindFrameUniformBlock(s_reveal_program);
+    hudInit(createCachedProgram(hudVertexShaderSource, nullptr, hudFragmentShaderSource), FRAME_UNIFORM_SLICES);
+    TRACE("programs ready in %.2f ms", armTicksToNs(armGetSystemTick() - start) * 1e-6);
 
     glGenVertexArrays(1, &s_vao);
-    glGenBuffers(1, &s_vbo);
+    glGenBuffers(1, &s_position_vbo);
+    glGenBuffers(1, &s_color_ssbo);
+    glGenBuffers(1, &s_rank_vbo);
+    glGenBuffers(1, &s_instance_vbo);
+    glGenBuffers(1, &s_ibo);
     // bind the Vertex Array Object first, then bind and set vertex buffer(s), and then configure vertex attributes(s).
     glBindVertexArray(s_vao);
 
-    glBindBuffer(GL_ARRAY_BUFFER, s_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sphere), sphere, GL_STATIC_DRAW);
+    // Positions never change: immutable storage with no client access lets the driver keep them in GPU memory
+    glBindBuffer(GL_ARRAY_BUFFER, s_position_vbo);
+    glBufferStorage(GL_ARRAY_BUFFER, sizeof(sphere_lods.vertices), sphere_lods.vertices, 0);
+
+    // Colors are rewritten by the CPU reveal, so only this small table is
+    // updatable. Kept in reveal order, each step uploads one contiguous run.
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, s_color_ssbo);
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, SPHERE_VERTEX_TOTAL * sizeof(glm::vec3), sphere_colors, GL_DYNAMIC_STORAGE_BIT);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, REVEAL_COLORS_BINDING, s_color_ssbo);
+    uploaded_colors_generation = sphere_colors_generation;
+    uploaded_colors_end = reveal_cursor;
+
+    // Reveal ranks only change when a new color is picked
+    glBindBuffer(GL_ARRAY_BUFFER, s_rank_vbo);
+    glBufferStorage(GL_ARRAY_BUFFER, SPHERE_VERTEX_TOTAL * sizeof(float), reveal_ranks, GL_DYNAMIC_STORAGE_BIT);
+    uploaded_ranks_generation = reveal_ranks_generation;
+
+    // Instances are rewritten every frame, into a persistently mapped ring with
+    // one slice per frame in flight, sized for the maximum count. The slices
+    // share the uniform ring's fences.
+    setInstanceCount(instance_count);
+    const GLbitfield map_flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glBindBuffer(GL_ARRAY_BUFFER, s_instance_vbo);
+    glBufferStorage(GL_ARRAY_BUFFER, sizeof(instances) * FRAME_UNIFORM_SLICES, nullptr, map_flags);
+    s_instance_map = (InstanceData*)glMapBufferRange(GL_ARRAY_BUFFER, 0, sizeof(instances) * FRAME_UNIFORM_SLICES, map_flags);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, position));
-    glEnableVertexAttribArray(0);
+    // Indirect draws written by the culling jobs, same ring. Nothing else draws indirect, so it stays bound.
+    const GLsizeiptr indirect_size = INSTANCE_MAX_SEGMENTS * sizeof(DrawElementsIndirectCommand) * FRAME_UNIFORM_SLICES;
+    glGenBuffers(1, &s_indirect_buffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, s_indirect_buffer);
+    glBufferStorage(GL_DRAW_INDIRECT_BUFFER, indirect_size, nullptr, map_flags);
+    s_indirect_map = (DrawElementsIndirectCommand*)glMapBufferRange(GL_DRAW_INDIRECT_BUFFER, 0, indirect_size, map_flags);
+
+    // The element buffer binding is part of the VAO state, so it stays bound
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s_ibo);
+    glBufferStorage(GL_ELEMENT_ARRAY_BUFFER, sizeof(sphere_lods.indices), sphere_lods.indices, 0);
+
+    glVertexAttribFormat(VertexAttrib_Position, 3, GL_FLOAT, GL_FALSE, 0);
+    glVertexAttribBinding(VertexAttrib_Position, VertexBinding_Position);
+    glBindVertexBuffer(VertexBinding_Position, s_position_vbo, 0, sizeof(glm::vec3));
+    glEnableVertexAttribArray(VertexAttrib_Position);
+
+    glVertexAttribFormat(VertexAttrib_RevealRank, 1, GL_FLOAT, GL_FALSE, 0);
+    glVertexAttribBinding(VertexAttrib_RevealRank, VertexBinding_RevealRank);
+    glBindVertexBuffer(VertexBinding_RevealRank, s_rank_vbo, 0, sizeof(float));
+    glEnableVertexAttribArray(VertexAttrib_RevealRank);
+
+    glVertexAttribFormat(VertexAttrib_InstanceOffsetScale, 4, GL_FLOAT, GL_FALSE, offsetof(InstanceData, offset_scale));
+    glVertexAttribBinding(VertexAttrib_InstanceOffsetScale, VertexBinding_Instance);
+    glEnableVertexAttribArray(VertexAttrib_InstanceOffsetScale);
+    glVertexAttribFormat(VertexAttrib_InstanceColor, 4, GL_FLOAT, GL_FALSE, offsetof(InstanceData, color));
+    glVertexAttribBinding(VertexAttrib_InstanceColor, VertexBinding_Instance);
+    glEnableVertexAttribArray(VertexAttrib_InstanceColor);
+    glVertexAttribFormat(VertexAttrib_InstanceClipOffset, 4, GL_FLOAT, GL_FALSE, offsetof(InstanceData, clip_offset));
+    glVertexAttribBinding(VertexAttrib_InstanceClipOffset, VertexBinding_Instance);
+    glEnableVertexAttribArray(VertexAttrib_InstanceClipOffset);
+    glVertexBindingDivisor(VertexBinding_Instance, 1);
+
+    // Ring of per-frame uniform slices, each aligned for glBindBufferRange
+    GLint alignment = 256;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    s_frame_ubo_stride = (sizeof(FrameUniforms) + alignment - 1) / alignment * alignment;
+    glGenBuffers(1, &s_frame_ubo);
+    glBindBuffer(GL_UNIFORM_BUFFER, s_frame_ubo);
+    glBufferStorage(GL_UNIFORM_BUFFER, s_frame_ubo_stride * FRAME_UNIFORM_SLICES, nullptr, map_flags);
+    s_frame_ubo_map = (u8*)glMapBufferRange(GL_UNIFORM_BUFFER, 0, s_frame_ubo_stride * FRAME_UNIFORM_SLICES, map_flags);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // GPU reveal state never leaves the GPU, the first compute pass fills it in
+    glGenBuffers(1, &s_reveal_ssbo);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, s_reveal_ssbo);
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, MAX_INSTANCES * sizeof(InstanceReveal), nullptr, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, REVEAL_STATE_BINDING, s_reveal_ssbo);
+
+    // Only the HUD switches VAO and program, and it puts both back, so they stay bound from here on
+    glBindVertexArray(s_vao);
+    sceneUseProgram();
 
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (void*)offsetof(Vertex, color));
-    glEnableVertexAttribArray(1);
+    glEnable(GL_CULL_FACE);
 
-    // note that this is allowed, the call to glVertexAttribPointer registered VBO as the vertex attribute's bound vertex buffer object so afterwards we can safely unbind
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    if (resolutionHasDepth()) {
+        // LEQUAL plus offset fill lets the two-pass wireframe's lines win over the fill they sit on
+        glEnable(GL_DEPTH_TEST);
+        glDepthFunc(GL_LEQUAL);
+        glEnable(GL_POLYGON_OFFSET_FILL);
+        glPolygonOffset(1.0f, 1.0f);
+    }
+}
 
-    // You can unbind the VAO afterwards so other VAO calls won't accidentally modify this VAO, but this rarely happens. Modifying other
-    // VAOs requires a call to glBindVertexArray anyways so we generally don't unbind VAOs (nor VBOs) when it's not directly necessary.
-    glBindVertexArray(0);
+// Only the GPU reveal needs this, the CPU one advances with the steps
+static void revealStep() {
+    if (reveal_mode != RevealMode_Gpu)
+        return;
 
-    glEnable(GL_CULL_FACE);
+    // Time driven, so the sweep speed doesn't depend on the frame rate
+    u64 elapsed_ns = armTicksToNs(sim_now - reveal_start_tick);
+    reveal_progress = (float)(elapsed_ns * 1e-9 / reveal_duration);
+    if (reveal_progress >= 1.0f) {
+        reveal_progress = 1.0f;
+        is_changing_color = false;
+    }
 }
 
-static void sceneRender() {
-    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-    glClear(GL_COLOR_BUFFER_BIT);
+static void simReset(u64 now) {
+    sim_step_ticks = armGetSystemTickFreq() / SIM_HZ;
+    sim_curr = SimState{ 0.0f, 0.0f };
+    sim_prev = sim_curr;
+    sim_tick = now;
+}
 
-    if (changed_indeces.size() < sizeof(sphere) / sizeof(Vertex)){
-        int i = rand() % 240;
-        while (true) {
-            i = rand() % 240;
-            if (changed_indeces.find(i) == changed_indeces.end())
-                break;
+// Steering in -1..1: the d-pad is all or nothing, the stick is proportional past its deadzone
+static float simInputAxis(u64 buttons, HidAnalogStickState stick) {
+    if (buttons & HidNpadButton_Left)
+        return -1.0f;
+    if (buttons & HidNpadButton_Right)
+        return 1.0f;
+
+    float x = stick.x / (float)JOYSTICK_MAX;
+    if (fabsf(x) < SIM_STICK_DEADZONE)
+        return 0.0f;
+    x = (fabsf(x) - SIM_STICK_DEADZONE) / (1.0f - SIM_STICK_DEADZONE) * (x < 0.0f ? -1.0f : 1.0f);
+    return x > 1.0f ? 1.0f : x < -1.0f ? -1.0f : x;
+}
+
+// One fixed step with the input sampled this frame
+static void simStep(float axis) {
+    sim_prev = sim_curr;
+
+    sim_curr.position_x += SIM_MOVE_PER_STEP * axis;
+    sim_curr.angle += SIM_TURN_PER_STEP * axis;
+
+    if (reveal_mode == RevealMode_Cpu) {
+        reveal_progress += 1.0f / (reveal_duration * SIM_HZ);
+        if (reveal_progress > 1.0f)
+            reveal_progress = 1.0f;
+
+        int end = revealCursorFor(reveal_progress);
+        for (; reveal_cursor < end; reveal_cursor++)
+            sphere_colors[reveal_cursor] = color;
+
+        if (reveal_cursor >= SPHERE_VERTEX_TOTAL)
+            is_changing_color = false;
+    }
+}
+
+// Runs every step due up to sim_now
+static void simAdvance(float axis) {
+    int steps = 0;
+    while (sim_now - sim_tick >= sim_step_ticks) {
+        if (steps == SIM_MAX_STEPS_PER_FRAME) {
+            sim_tick = sim_now - sim_step_ticks;
+            break;
         }
-        sphere[i].color = color; 
-        sphere[i].color = color; 
-        sphere[i].color = color; 
-        changed_indeces.insert(i);
-    }
-    if (changed_indeces.size() < sizeof(sphere) / sizeof(Vertex)){
-        int i = rand() % 240;
-        while (true) {
-            i = rand() % 240;
-            if (changed_indeces.find(i) == changed_indeces.end())
-                break;
+        simStep(axis);
+        sim_tick += sim_step_ticks;
+        steps++;
+    }
+}
+
+//-----------------------------------------------------------------------------
+// Frame pipeline
+//-----------------------------------------------------------------------------
+
+// Everything the render thread needs from one simulation frame. The tables are
+// only copied into a slot when they changed since that slot was last written,
+// so a steady scene costs a few hundred bytes per snapshot.
+struct FrameSnapshot {
+    SimState sim_prev, sim_curr;
+    u64 sim_tick;
+    u64 sim_step_ticks;
+    u64 input_tick; // when the pad state behind this snapshot was read
+    float sim_ms;   // simulation CPU time that produced it
+
+    glm::vec3 color;
+    glm::vec3 reveal_from_color;
+    RevealMode reveal_mode;
+    u64 reveal_start_tick;
+
+    u32 instances_generation;
+    int instance_count;
+    int lod_first_instance[ICOSPHERE_LEVEL_COUNT];
+    int lod_instance_count[ICOSPHERE_LEVEL_COUNT];
+    float instance_bob;
+    InstanceData instances[MAX_INSTANCES]; // grid positions, animated per frame by the render thread
+
+    u32 reveal_ranks_generation;
+    float reveal_ranks[SPHERE_VERTEX_TOTAL];
+
+    u32 sphere_colors_generation;
+    int sphere_colors_end; // reveal_cursor, positions from here on are as the generation began
+    glm::vec3 sphere_colors[SPHERE_VERTEX_TOTAL];
+};
+
+static FrameSnapshot s_snapshots[PIPELINE_SLOTS];
+static PipelineSlots s_snapshot_slots;
+
+// Actions the simulation can't take itself because they touch EGL, GL or
+// TRACE, collected until the render thread picks them up
+enum SimRequest {
+    SimRequest_Quit = BIT(0),
+    SimRequest_CyclePacing = BIT(1),
+    SimRequest_ToggleWireframe = BIT(2),
+    SimRequest_ToggleLateLatch = BIT(3),
+    SimRequest_CyclePerf = BIT(4),
+    SimRequest_ToggleHud = BIT(5),
+    SimRequest_Capture = BIT(6),
+};
+static std::atomic<u32> sim_requests(0);
+
+static void simRequest(u32 request) {
+    sim_requests.fetch_or(request, std::memory_order_release);
+}
+
+static void simPublish(u64 input_tick, float sim_ms) {
+    FrameSnapshot* s = &s_snapshots[s_snapshot_slots.back];
+    s->sim_prev = sim_prev;
+    s->sim_curr = sim_curr;
+    s->sim_tick = sim_tick;
+    s->sim_step_ticks = sim_step_ticks;
+    s->input_tick = input_tick;
+    s->sim_ms = sim_ms;
+
+    s->color = color;
+    s->reveal_from_color = reveal_from_color;
+    s->reveal_mode = reveal_mode;
+    s->reveal_start_tick = reveal_start_tick;
+
+    if (s->instances_generation != instances_generation) {
+        s->instance_count = instance_count;
+        memcpy(s->lod_first_instance, lod_first_instance, sizeof(lod_first_instance));
+        memcpy(s->lod_instance_count, lod_instance_count, sizeof(lod_instance_count));
+        s->instance_bob = instance_bob;
+        memcpy(s->instances, instances, instance_count * sizeof(InstanceData));
+        s->instances_generation = instances_generation;
+    }
+    if (s->reveal_ranks_generation != reveal_ranks_generation) {
+        memcpy(s->reveal_ranks, reveal_ranks, sizeof(reveal_ranks));
+        s->reveal_ranks_generation = reveal_ranks_generation;
+    }
+    if (s->sphere_colors_generation != sphere_colors_generation) {
+        memcpy(s->sphere_colors, sphere_colors, sizeof(sphere_colors));
+        s->sphere_colors_generation = sphere_colors_generation;
+    }
+    else if (s->sphere_colors_end < reveal_cursor) {
+        memcpy(s->sphere_colors + s->sphere_colors_end, sphere_colors + s->sphere_colors_end,
+               (reveal_cursor - s->sphere_colors_end) * sizeof(glm::vec3));
+    }
+    s->sphere_colors_end = reveal_cursor;
+
+    pipelinePublish(&s_snapshot_slots);
+}
+
+static void simProcessInput(u64 buttons_state, u64 keys_down) {
+    // color still holds the previous target here, which is what a restarted reveal fades from
+    //switch to blue
+    if (buttons_state & (HidNpadButton_Up | HidNpadButton_StickLUp)) {
+        selected_color = 2;
+        if (prev_color != selected_color) {
+            is_changing_color = true;
+            revealRestart(color);
         }
-        sphere[i].color = color; 
-        sphere[i].color = color; 
-        sphere[i].color = color; 
-        changed_indeces.insert(i);
-    }
-    if (changed_indeces.size() < sizeof(sphere) / sizeof(Vertex)){
-        int i = rand() % 240;
-        while (true) {
-            i = rand() % 240;
-            if (changed_indeces.find(i) == changed_indeces.end())
-                break;
+        else is_changing_color = false;
+    }
+    else if (buttons_state & (HidNpadButton_Down | HidNpadButton_StickLDown)) {
+        selected_color = 1;
+        if (prev_color != selected_color) {
+            is_changing_color = true;
+            revealRestart(color);
         }
-        sphere[i].color = color; 
-        sphere[i].color = color; 
-        sphere[i].color = color; 
-        changed_indeces.insert(i);
-    }
-    if (changed_indeces.size() < sizeof(sphere) / sizeof(Vertex)){
-        int i = rand() % 240;
-        while (true) {
-            i = rand() % 240;
-            if (changed_indeces.find(i) == changed_indeces.end())
-                break;
+        else is_changing_color = false;
+    }
+    else {
+        selected_color = 0;
+        if (prev_color != selected_color) {
+            is_changing_color = true;
+            revealRestart(color);
+        }
+        else is_changing_color = false;
+    }
+
+    if (keys_down & HidNpadButton_Minus) {
+        simReset(sim_now);
+    }
+    else if (keys_down & HidNpadButton_Plus) {
+        simRequest(SimRequest_Quit);
+    }
+
+    // L + A cycles the pacing mode, L + B the performance profile, R + A shows the HUD
+    if ((buttons_state & HidNpadButton_L) && (keys_down & HidNpadButton_A))
+        simRequest(SimRequest_CyclePacing);
+    if ((buttons_state & HidNpadButton_L) && (keys_down & HidNpadButton_B))
+        simRequest(SimRequest_CyclePerf);
+    if ((buttons_state & HidNpadButton_R) && (keys_down & HidNpadButton_A))
+        simRequest(SimRequest_ToggleHud);
+    // L + X records the next frames for replay
+    if ((buttons_state & HidNpadButton_L) && (keys_down & HidNpadButton_X))
+        simRequest(SimRequest_Capture);
+
+    // ZR / ZL double / halve the number of instanced spheres
+    if (keys_down & HidNpadButton_ZR)
+        setInstanceCount(instance_count * 2);
+    else if (keys_down & HidNpadButton_ZL)
+        setInstanceCount(instance_count / 2);
+
+    if (keys_down & HidNpadButton_StickL)
+        simRequest(SimRequest_ToggleLateLatch);
+
+    if (keys_down & HidNpadButton_Y)
+        revealSetMode(reveal_mode == RevealMode_Gpu ? RevealMode_Cpu : RevealMode_Gpu);
+    if ((keys_down & HidNpadButton_X) && !(buttons_state & HidNpadButton_L))
+        simRequest(SimRequest_ToggleWireframe);
+
+    switch(selected_color) {
+        case 0:
+            color = glm::vec3(1.0f, 0.0f, 0.0f);
+            break;
+        case 1:
+            color = glm::vec3(0.0f, 1.0f, 0.0f);
+            break;
+        case 2:
+            color = glm::vec3(0.0f, 0.0f, 1.0f);
+            break;
+        default:
+            break;
+    }
+    prev_color = selected_color;
+}
+
+// One simulation frame: input, every step due by now, then a snapshot for the render thread
+static void simFrame(u64 now, u64 input_tick, u64 buttons_state, u64 keys_down, HidAnalogStickState stick) {
+    u64 start = armGetSystemTick();
+    sim_now = now;
+
+    // Docking changed the window (LODs are picked by projected size), or the
+    // performance profile lowered the budget below the current count
+    if (s_layout_height.load(std::memory_order_acquire) != sim_layout_height ||
+        instance_count > s_instance_budget.load(std::memory_order_relaxed))
+        setInstanceCount(instance_count);
+
+    simProcessInput(buttons_state, keys_down);
+    // Movement and the CPU reveal run at the fixed rate, after the color for this frame is known
+    simAdvance(simInputAxis(buttons_state, stick));
+    revealStep();
+
+    simPublish(input_tick, profilerTicksToMs(armGetSystemTick() - start));
+}
+
+// The simulation thread runs next to the render thread, which owns the EGL
+// context, on a core of its own. It never TRACEs or touches GL.
+#define SIM_THREAD_CORE 1
+#define SIM_THREAD_PRIORITY 0x2C // same as the main thread
+#define SIM_THREAD_STACK_SIZE 0x10000
+
+static Thread s_sim_thread;
+static std::atomic<bool> s_sim_thread_running(false);
+
+static void simThreadMain(void* arg) {
+    // A pad state of its own, button edges are seen at the simulation rate
+    PadState pad;
+    padInitializeDefault(&pad);
+
+    while (s_sim_thread_running.load(std::memory_order_acquire)) {
+        // Sleep until the next step is due
+        u64 now = armGetSystemTick();
+        u64 due = sim_tick + sim_step_ticks;
+        if (due > now) {
+            svcSleepThread(armTicksToNs(due - now));
+            now = armGetSystemTick();
         }
-        sphere[i].color = color; 
-        sphere[i].color = color; 
-        sphere[i].color = color; 
-        changed_indeces.insert(i);
+
+        padUpdate(&pad);
+        simFrame(now, now, padGetButtons(&pad), padGetButtonsDown(&pad), padGetStickPos(&pad, 0));
+    }
+}
+
+static bool simThreadStart() {
+    s_sim_thread_running = true;
+    if (R_FAILED(threadCreate(&s_sim_thread, simThreadMain, nullptr, nullptr, SIM_THREAD_STACK_SIZE, SIM_THREAD_PRIORITY, SIM_THREAD_CORE))) {
+        s_sim_thread_running = false;
+        TRACE("no simulation thread, simulating on the render thread");
+        return false;
+    }
+    threadStart(&s_sim_thread);
+    return true;
+}
+
+static void simThreadStop() {
+    if (!s_sim_thread_running)
+        return;
+    s_sim_thread_running = false;
+    threadWaitForExit(&s_sim_thread);
+    threadClose(&s_sim_thread);
+}
+
+//-----------------------------------------------------------------------------
+// Rendering, on the thread that owns the EGL context
+//-----------------------------------------------------------------------------
+
+// Time the current frame is drawn at, same clock as sim_now
+static u64 frame_tick = 0;
+
+// Late latch: the pad is read a second time right before the frame's transform
+// is built, and the pose is extrapolated from the last step with that input
+// instead of interpolated between the last two steps, which trails by a step
+static bool late_latch = true;
+static bool late_input_valid = false;
+static float late_input_axis = 0.0f;
+
+static RevealMode drawn_reveal_mode = RevealMode_Gpu;
+
+// What the next reveal compute pass does besides advancing every sphere
+enum RevealCommand {
+    RevealCommand_Advance = 0,
+    RevealCommand_Restart = 1, // new target color, each sphere fades from where it is
+    RevealCommand_Sync = 2,    // new slots or back from the CPU reveal, every sphere follows the global reveal
+};
+
+static RevealCommand reveal_command = RevealCommand_Sync;
+static u64 drawn_reveal_start_tick = 0;
+static u64 reveal_epoch_tick = 0;
+
+// Uploads the tables that changed since the last frame drawn. The simulation
+// can't TRACE, so its changes are reported here as they reach the screen.
+static void sceneUploadSnapshot(const FrameSnapshot* s) {
+    if (s->instances_generation != drawn_instances_generation) {
+        drawn_instances_generation = s->instances_generation;
+        TRACE("instances: %d, per lod %d/%d/%d/%d/%d", s->instance_count, s->lod_instance_count[0], s->lod_instance_count[1],
+              s->lod_instance_count[2], s->lod_instance_count[3], s->lod_instance_count[4]);
+        reveal_command = RevealCommand_Sync;
+    }
+
+    if (s->reveal_ranks_generation != uploaded_ranks_generation) {
+        glBindBuffer(GL_ARRAY_BUFFER, s_rank_vbo);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, SPHERE_VERTEX_TOTAL * sizeof(float), s->reveal_ranks);
+        uploaded_ranks_generation = s->reveal_ranks_generation;
+    }
+
+    // A rewritten table goes up whole, otherwise just the run painted since the last upload
+    bool colors_rewritten = s->sphere_colors_generation != uploaded_colors_generation;
+    int colors_begin = colors_rewritten ? 0 : uploaded_colors_end;
+    int colors_end = colors_rewritten ? SPHERE_VERTEX_TOTAL : s->sphere_colors_end;
+    if (colors_begin < colors_end) {
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, s_color_ssbo);
+        glBufferSubData(GL_SHADER_STORAGE_BUFFER, colors_begin * sizeof(glm::vec3), (colors_end - colors_begin) * sizeof(glm::vec3),
+                        s->sphere_colors + colors_begin);
+    }
+    uploaded_colors_generation = s->sphere_colors_generation;
+    uploaded_colors_end = s->sphere_colors_end;
+
+    if (s->reveal_mode != drawn_reveal_mode) {
+        drawn_reveal_mode = s->reveal_mode;
+        TRACE("reveal mode: %s", drawn_reveal_mode == RevealMode_Gpu ? "gpu" : "cpu");
+        reveal_command = RevealCommand_Sync;
+    }
+
+    if (s->reveal_start_tick != drawn_reveal_start_tick) {
+        drawn_reveal_start_tick = s->reveal_start_tick;
+        if (reveal_command == RevealCommand_Advance)
+            reveal_command = RevealCommand_Restart;
+    }
+}
+
+// Times handed to the compute pass, from startup so floats keep enough precision
+static float revealSeconds(u64 tick) {
+    return tick > reveal_epoch_tick ? (float)(armTicksToNs(tick - reveal_epoch_tick) * 1e-9) : 0.0f;
+}
+
+// Model matrix between the last two steps, by how far frame_tick is into the next one
+static glm::mat4 simModelMatrix(const FrameSnapshot* s) {
+    float alpha = frame_tick > s->sim_tick ? (float)(frame_tick - s->sim_tick) / (float)s->sim_step_ticks : 0.0f;
+    if (alpha > 1.0f)
+        alpha = 1.0f;
+    float x, angle;
+    if (late_input_valid) {
+        x = s->sim_curr.position_x + SIM_MOVE_PER_STEP * late_input_axis * alpha;
+        angle = s->sim_curr.angle + SIM_TURN_PER_STEP * late_input_axis * alpha;
     }
     else {
-        is_changing_color = false;
+        x = glm::mix(s->sim_prev.position_x, s->sim_curr.position_x, alpha);
+        angle = glm::mix(s->sim_prev.angle, s->sim_curr.angle, alpha);
     }
 
-    glBindBuffer(GL_ARRAY_BUFFER, s_vbo);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(sphere), sphere, GL_STATIC_DRAW);
+    glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(x, 0.0f, 0.0f));
+    return glm::rotate(model, angle, glm::vec3(0.0f, 1.0f, 0.0f));
+}
 
-    glUniformMatrix4fv(transformation_uniform_loc, 1, GL_FALSE, glm::value_ptr(transformation_matrix));
-    glUniformMatrix4fv(translation_uniform_loc, 1, GL_FALSE, glm::value_ptr(translation_matrix));
+// Waits until the GPU is done with the frame that last used the current ring slice
+static void waitFrameSlice() {
+    GLsync fence = s_frame_ubo_fences[s_frame_ubo_slice];
+    if (fence) {
+        allocPause();
+        glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+        glDeleteSync(fence);
+        allocResume();
+        s_frame_ubo_fences[s_frame_ubo_slice] = nullptr;
+    }
+}
 
-    glUniform3fv(color_uniform_loc, 1, glm::value_ptr(sphere_base_color));
+// Per-frame instance pass, run as a parallel for straight into the mapped
+// slices. Each segment is a run of instances that share a LOD; its job moves
+// every instance, culls it against the frustum by the LOD's bounding sphere and
+// packs the visible ones at the start of the segment, then writes the segment's
+// indirect draw. Empty segments stay in the list with no instances. The list
+// itself is rebuilt every frame in the frame arena.
+struct InstanceSegment {
+    int begin, end;
+    int level;
+};
+
+static int s_instance_segment_count = 0;
+static int s_visible_instances = 0; // after culling, in the last frame drawn
+
+struct InstanceJob {
+    const FrameSnapshot* snapshot;
+    const InstanceSegment* segments;
+    InstanceData* out;
+    DrawElementsIndirectCommand* commands;
+    glm::mat4 model;
+    float phase; // radians into the bob period
+    std::atomic<int> visible;
+};
+
+static void instanceJobRange(void* ctx, int begin, int end) {
+    InstanceJob* job = (InstanceJob*)ctx;
+    const FrameSnapshot* s = job->snapshot;
+    int visible_total = 0;
+    for (int seg = begin; seg < end; seg++) {
+        const InstanceSegment& segment = job->segments[seg];
+        const IcosphereLod& lod = sphere_lods.levels[segment.level];
+        const MeshPosition& c = lod.mesh.center;
+
+        int visible = 0;
+        for (int i = segment.begin; i < segment.end; i++) {
+            const InstanceData& base = s->instances[i];
+            float scale = base.offset_scale.w;
+            // Each sphere bobs with a phase of its own, hashed from its slot
+            float phase = job->phase + ((i * 2654435761u) >> 16) * (glm::radians(360.0f) / 65536.0f);
+            glm::vec3 offset = glm::vec3(base.offset_scale.x, base.offset_scale.y + s->instance_bob * sinf(phase), base.offset_scale.z);
+
+            // Same transform as the vertex shader: shared model, then the instance offset
+            glm::vec4 center = job->model * glm::vec4(c.x * scale, c.y * scale, c.z * scale, 1.0f);
+            if (!cameraSphereVisible(&s_camera, glm::vec3(center.x + offset.x, center.y + offset.y, center.z + offset.z), lod.mesh.radius * scale))
+                continue;
+
+            InstanceData& out = job->out[segment.begin + visible++];
+            out.offset_scale = glm::vec4(offset, scale);
+            out.clip_offset = cameraClipOffset(&s_camera, offset);
+            out.color = glm::vec4(base.color.x, base.color.y, base.color.z, (float)i);
+        }
 
+        DrawElementsIndirectCommand& command = job->commands[seg];
+        command.count = lod.mesh.index_count;
+        command.instance_count = visible;
+        command.first_index = lod.first_index;
+        command.base_vertex = lod.base_vertex;
+        command.base_instance = segment.begin;
+        visible_total += visible;
+    }
+    job->visible.fetch_add(visible_total, std::memory_order_relaxed);
+}
 
-    // draw our first triangle
-    glUseProgram(s_program);
-    glBindVertexArray(s_vao);  // seeing as we only have a single VAO there's no need to bind it every time, but we'll do so to keep things a bit more organized
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    glDrawArrays(GL_TRIANGLES, 0, 240 * 3);
-    glUniform3fv(color_uniform_loc, 1, glm::value_ptr(line_color));
-    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-    glDrawArrays(GL_TRIANGLES, 0, 240 * 3);
+// Cuts every LOD range into segments of at most INSTANCE_JOB_GRAIN instances,
+// nothing is drawn if the frame arena is out of space
+static const InstanceSegment* buildInstanceSegments(const FrameSnapshot* s) {
+    s_instance_segment_count = 0;
+    InstanceSegment* segments = arenaAllocArray<InstanceSegment>(&s_frame_arena, INSTANCE_MAX_SEGMENTS);
+    if (!segments)
+        return nullptr;
+    for (int level = 0; level < ICOSPHERE_LEVEL_COUNT; level++) {
+        int end = s->lod_first_instance[level] + s->lod_instance_count[level];
+        for (int begin = s->lod_first_instance[level]; begin < end; begin += INSTANCE_JOB_GRAIN) {
+            InstanceSegment& segment = segments[s_instance_segment_count++];
+            segment.begin = begin;
+            segment.end = begin + INSTANCE_JOB_GRAIN < end ? begin + INSTANCE_JOB_GRAIN : end;
+            segment.level = level;
+        }
+    }
+    return segments;
+}
+
+static void writeInstances(const FrameSnapshot* s, const glm::mat4& model) {
+    InstanceJob job;
+    job.snapshot = s;
+    job.segments = buildInstanceSegments(s);
+    job.out = s_instance_map + s_frame_ubo_slice * MAX_INSTANCES;
+    job.commands = s_indirect_map + s_frame_ubo_slice * INSTANCE_MAX_SEGMENTS;
+    job.model = model;
+    job.phase = (float)(armTicksToNs(frame_tick) % INSTANCE_BOB_PERIOD_NS) / INSTANCE_BOB_PERIOD_NS * glm::radians(360.0f);
+    job.visible.store(0, std::memory_order_relaxed);
+    jobsParallelFor(s_instance_segment_count, 1, instanceJobRange, &job);
+    s_visible_instances = job.visible.load(std::memory_order_relaxed);
+
+    glBindVertexBuffer(VertexBinding_Instance, s_instance_vbo, s_frame_ubo_slice * sizeof(instances), sizeof(InstanceData));
+}
+
+// One write into the next ring slice replaces the individual glUniform calls
+static void writeFrameUniforms(const FrameSnapshot* s, const glm::mat4& model) {
+    FrameUniforms* u = (FrameUniforms*)(s_frame_ubo_map + s_frame_ubo_slice * s_frame_ubo_stride);
+    u->mvp = cameraModelViewProjection(&s_camera, model);
+    u->base_color = glm::vec4(sphere_base_color, 1.0f);
+    u->line_color = glm::vec4(line_color, 1.0f);
+    u->reveal_from_color = glm::vec4(s->reveal_from_color, 1.0f);
+    u->reveal_to_color = glm::vec4(s->color, 1.0f);
+    u->reveal_params = glm::vec4((float)reveal_command, s->reveal_mode == RevealMode_Gpu ? 1.0f : 0.0f, line_width, (float)s->instance_count);
+    // The GPU reveal is time driven, so it is evaluated at the time the frame is drawn
+    u->reveal_clock = glm::vec4(revealSeconds(frame_tick), revealSeconds(s->reveal_start_tick), reveal_duration, REVEAL_INSTANCE_SPREAD);
+
+    glBindBufferRange(GL_UNIFORM_BUFFER, FRAME_UNIFORMS_BINDING, s_frame_ubo, s_frame_ubo_slice * s_frame_ubo_stride, sizeof(FrameUniforms));
+}
+
+// A single dispatch advances every sphere's reveal, so the CPU side costs the same for any count
+static void revealPass(const FrameSnapshot* s) {
+    if (s->reveal_mode != RevealMode_Gpu)
+        return;
+    profilerGpuBegin(ProfileGpu_Reveal);
+    glUseProgram(s_reveal_program);
+    glDispatchCompute((s->instance_count + REVEAL_GROUP_SIZE - 1) / REVEAL_GROUP_SIZE, 1, 1);
+    glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+    sceneUseProgram();
+    profilerGpuEnd(ProfileGpu_Reveal);
+    reveal_command = RevealCommand_Advance;
+}
+
+// Every segment in one call, from this frame's slice of the indirect buffer
+static void drawSpheres() {
+    glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT,
+                                (const void*)(s_frame_ubo_slice * INSTANCE_MAX_SEGMENTS * sizeof(DrawElementsIndirectCommand)),
+                                s_instance_segment_count, 0);
+}
+
+static void sceneRender(const FrameSnapshot* snapshot) {
+    resolutionBeginFrame();
+    glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+    glClear(resolutionHasDepth() ? GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT : GL_COLOR_BUFFER_BIT);
+
+    profilerCpuBegin(ProfileCpu_Render);
+    profilerGpuBegin(ProfileGpu_Upload);
+    sceneUploadSnapshot(snapshot);
+    profilerGpuEnd(ProfileGpu_Upload);
+
+    waitFrameSlice();
+    glm::mat4 model = simModelMatrix(snapshot);
+    writeInstances(snapshot, model);
+    writeFrameUniforms(snapshot, model);
+    revealPass(snapshot);
+
+    if (wireframe_mode == WireframeMode_SinglePass) {
+        // Fill and outline share a draw, so they are reported together as the fill pass
+        profilerGpuBegin(ProfileGpu_Fill);
+        drawSpheres();
+        profilerGpuEnd(ProfileGpu_Fill);
+    }
+    else {
+        // s_program is already bound, the line pass hands it back when done
+        profilerGpuBegin(ProfileGpu_Fill);
+        drawSpheres();
+        profilerGpuEnd(ProfileGpu_Fill);
+
+        profilerGpuBegin(ProfileGpu_Line);
+        glUseProgram(s_line_program);
+        glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
+        drawSpheres();
+        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        glUseProgram(s_program);
+        profilerGpuEnd(ProfileGpu_Line);
+    }
+    profilerCpuEnd(ProfileCpu_Render);
+}
+
+#define HUD_REFRESH_NS 250000000ULL // text is formatted 4 times a second, drawn every frame
+#define HUD_AVERAGE_SAMPLES 30
+
+static bool hud_visible = false;
+static u64 hud_refresh_tick = 0;
+
+static float hudCpuMs(ProfileCpuZone zone) {
+    return profilerRecentMs(&s_profiler.cpu[zone], HUD_AVERAGE_SAMPLES);
+}
+
+static float hudGpuMs(ProfileGpuZone zone) {
+    return profilerRecentMs(&s_profiler.gpu[zone], HUD_AVERAGE_SAMPLES);
+}
+
+static void sceneUpdateHud(const FrameSnapshot* s) {
+    float frame_ms = hudCpuMs(ProfileCpu_Frame);
+    float busy[PROFILER_CORES];
+    for (int core = 0; core < PROFILER_CORES; core++)
+        busy[core] = frame_ms > 0.0f ? profilerRecentMs(&s_profiler.cores[core], HUD_AVERAGE_SAMPLES) / frame_ms * 100.0f : 0.0f;
+
+    hudClear();
+    hudPrint(0, "%5.1f fps  cpu %5.2f  gpu %5.2f ms", frame_ms > 0.0f ? 1000.0f / frame_ms : 0.0f, frame_ms, hudGpuMs(ProfileGpu_Frame));
+    hudPrint(1, "cpu  input %4.2f  sim %4.2f  render %4.2f", hudCpuMs(ProfileCpu_Input), hudCpuMs(ProfileCpu_Sim), hudCpuMs(ProfileCpu_Render));
+    hudPrint(2, "     latch %4.2f  pace %5.2f  swap %5.2f", hudCpuMs(ProfileCpu_Latch), hudCpuMs(ProfileCpu_Pace), hudCpuMs(ProfileCpu_Swap));
+    hudPrint(3, "gpu  upload %4.2f  fill %5.2f  line %5.2f", hudGpuMs(ProfileGpu_Upload), hudGpuMs(ProfileGpu_Fill), hudGpuMs(ProfileGpu_Line));
+    hudPrint(4, "     reveal %4.2f  upscale %4.2f  input latency %5.1f", hudGpuMs(ProfileGpu_Reveal), hudGpuMs(ProfileGpu_Upscale),
+             hudGpuMs(ProfileGpu_InputLatency));
+    hudPrint(5, "hud  cpu %4.2f  gpu %4.2f ms", hudCpuMs(ProfileCpu_Hud), hudGpuMs(ProfileGpu_Hud));
+    hudPrint(6, "spheres %d/%d drawn", s_visible_instances, s->instance_count);
+    hudPrint(7, "render %dx%d, %s", s_resolution.render_width, s_resolution.render_height, s_pacing_mode_names[s_pacing.mode]);
+    hudPrint(8, "perf %s: cpu %.0f gpu %.0f emc %.0f mhz", s_profiler.perf_name ? s_profiler.perf_name : "?",
+             s_profiler.clock_mhz[0], s_profiler.clock_mhz[1], s_profiler.clock_mhz[2]);
+    hudPrint(9, "jobs %3.0f%% %3.0f%% %3.0f%%  log dropped %u", busy[0], busy[1], busy[2], nxlinkDroppedCount());
+    hudPrint(10, "heap %u allocs  arena %u kib", s_profiler.heap_allocations_total, (u32)(s_frame_arena.high_water / 1024));
+}
+
+// Drawn into the window after the upscale, so it stays sharp at any render scale
+static void sceneDrawHud(const FrameSnapshot* s) {
+    profilerCpuBegin(ProfileCpu_Hud);
+    profilerGpuBegin(ProfileGpu_Hud);
+    u64 now = armGetSystemTick();
+    if (now - hud_refresh_tick >= armNsToTicks(HUD_REFRESH_NS)) {
+        hud_refresh_tick = now;
+        sceneUpdateHud(s);
+    }
+
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+    hudDraw(s_frame_ubo_slice, s_resolution.window_width, s_resolution.window_height);
+    glEnable(GL_CULL_FACE);
+    if (resolutionHasDepth())
+        glEnable(GL_DEPTH_TEST);
+    glBindVertexArray(s_vao);
+    sceneUseProgram();
+    profilerGpuEnd(ProfileGpu_Hud);
+    profilerCpuEnd(ProfileCpu_Hud);
+}
+
+// The slice may be rewritten once the GPU is past this frame's draws, the HUD's included
+static void sceneEndFrame() {
+    // The driver allocates every sync object, which isn't ours to count
+    allocPause();
+    s_frame_ubo_fences[s_frame_ubo_slice] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    allocResume();
+    s_frame_ubo_slice = (s_frame_ubo_slice + 1) % FRAME_UNIFORM_SLICES;
+}
+
+//-----------------------------------------------------------------------------
+// Capture and replay
+//-----------------------------------------------------------------------------
+
+// A record holds what sceneRender() consumed in a frame: the render thread's
+// own inputs, the fixed part of the snapshot, the tables the frame uploaded
+// (all of them in the first frame) and, last, the frame's timings
+enum CaptureTable {
+    CaptureTable_Instances = BIT(0),
+    CaptureTable_Ranks = BIT(1),
+    CaptureTable_Colors = BIT(2),
+};
+
+struct CaptureFrameState {
+    u64 frame_tick;
+    u64 reveal_epoch_tick;
+    float late_input_axis;
+    u32 late_input_valid;
+    u32 wireframe_mode;
+    u32 tables; // CaptureTable bits
+    float render_scale;
+};
+
+struct CaptureTimings {
+    float cpu_ms[ProfileCpu_Count]; // latest samples as the frame ended
+    float gpu_ms[ProfileGpu_Count]; // these lag PROFILER_GPU_LATENCY frames behind
+};
+
+#define CAPTURE_SNAPSHOT_PREFIX offsetof(FrameSnapshot, instances)
+// Largest record captureSceneFrame and captureFrameTimings write, every table
+// at the full instance count
+#define CAPTURE_RECORD_MAX ((u32)(sizeof(u32) + sizeof(CaptureFrameState) + CAPTURE_SNAPSHOT_PREFIX + \
+                                  MAX_INSTANCES * sizeof(InstanceData) + \
+                                  sizeof(u32) + sizeof(FrameSnapshot::reveal_ranks) + \
+                                  sizeof(u32) + sizeof(int) + sizeof(FrameSnapshot::sphere_colors) + \
+                                  sizeof(CaptureTimings)))
+// Changes with the record layout, a capture only replays on a matching build
+#define CAPTURE_LAYOUT ((u32)(1 | ProfileCpu_Count << 4 | ProfileGpu_Count << 8) ^ (u32)(sizeof(FrameSnapshot) << 12))
+
+static FrameSnapshot s_replay_snapshot;
+static CaptureTimings s_replay_timings;
+
+// Before sceneRender(), which updates the uploaded generations
+static void captureSceneFrame(const FrameSnapshot* s) {
+    bool first = captureFrameCount() == 0;
+    CaptureFrameState state;
+    state.frame_tick = frame_tick;
+    state.reveal_epoch_tick = reveal_epoch_tick;
+    state.late_input_axis = late_input_axis;
+    state.late_input_valid = late_input_valid;
+    state.wireframe_mode = wireframe_mode;
+    state.tables = 0;
+    if (first || s->instances_generation != drawn_instances_generation)
+        state.tables |= CaptureTable_Instances;
+    if (first || s->reveal_ranks_generation != uploaded_ranks_generation)
+        state.tables |= CaptureTable_Ranks;
+    if (first || s->sphere_colors_generation != uploaded_colors_generation || s->sphere_colors_end != uploaded_colors_end)
+        state.tables |= CaptureTable_Colors;
+    state.render_scale = s_resolution.scale;
+
+    captureBeginFrame();
+    captureWrite(&state, sizeof(state));
+    captureWrite(s, CAPTURE_SNAPSHOT_PREFIX);
+    if (state.tables & CaptureTable_Instances)
+        captureWrite(s->instances, s->instance_count * sizeof(InstanceData));
+    if (state.tables & CaptureTable_Ranks) {
+        captureWrite(&s->reveal_ranks_generation, sizeof(s->reveal_ranks_generation));
+        captureWrite(s->reveal_ranks, sizeof(s->reveal_ranks));
+    }
+    if (state.tables & CaptureTable_Colors) {
+        captureWrite(&s->sphere_colors_generation, sizeof(s->sphere_colors_generation));
+        captureWrite(&s->sphere_colors_end, sizeof(s->sphere_colors_end));
+        captureWrite(s->sphere_colors, sizeof(s->sphere_colors));
+    }
+}
+
+// After profilerEndFrame(), closes the record
+static void captureFrameTimings() {
+    CaptureTimings timings;
+    for (int zone = 0; zone < ProfileCpu_Count; zone++)
+        timings.cpu_ms[zone] = profilerRecentMs(&s_profiler.cpu[zone], 1);
+    for (int zone = 0; zone < ProfileGpu_Count; zone++)
+        timings.gpu_ms[zone] = profilerRecentMs(&s_profiler.gpu[zone], 1);
+    captureWrite(&timings, sizeof(timings));
+    captureEndFrame();
+}
+
+// Restores a captured frame into s_replay_snapshot and the render state.
+// Frames must be replayed in order from the first, which carries every table;
+// the tables a frame carries are uploaded again, as they were when captured.
+static bool replaySceneFrame(u32 frame) {
+    replaySeek(frame);
+    CaptureFrameState state;
+    FrameSnapshot* s = &s_replay_snapshot;
+    if (!replayRead(&state, sizeof(state)) || !replayRead(s, CAPTURE_SNAPSHOT_PREFIX) ||
+        s->instance_count < 1 || s->instance_count > MAX_INSTANCES)
+        return false;
+    if (state.tables & CaptureTable_Instances) {
+        if (!replayRead(s->instances, s->instance_count * sizeof(InstanceData)))
+            return false;
+        drawn_instances_generation = 0;
+    }
+    if (state.tables & CaptureTable_Ranks) {
+        if (!replayRead(&s->reveal_ranks_generation, sizeof(s->reveal_ranks_generation)) ||
+            !replayRead(s->reveal_ranks, sizeof(s->reveal_ranks)))
+            return false;
+        uploaded_ranks_generation = 0;
+    }
+    if (state.tables & CaptureTable_Colors) {
+        if (!replayRead(&s->sphere_colors_generation, sizeof(s->sphere_colors_generation)) ||
+            !replayRead(&s->sphere_colors_end, sizeof(s->sphere_colors_end)) ||
+            !replayRead(s->sphere_colors, sizeof(s->sphere_colors)))
+            return false;
+        uploaded_colors_generation = 0;
+    }
+    if (!replayRead(&s_replay_timings, sizeof(s_replay_timings)))
+        return false;
+
+    frame_tick = state.frame_tick;
+    reveal_epoch_tick = state.reveal_epoch_tick;
+    late_input_axis = state.late_input_axis;
+    late_input_valid = state.late_input_valid != 0;
+    if (wireframe_mode != (WireframeMode)state.wireframe_mode) {
+        wireframe_mode = (WireframeMode)state.wireframe_mode;
+        sceneUseProgram();
+    }
+    if (state.render_scale != s_resolution.scale)
+        resolutionApplyScale(state.render_scale);
+    return true;
+}
+
+// Checks every record once and reports what the capture measured
+static bool replayPrepare() {
+    double cpu_ms = 0.0, gpu_ms = 0.0;
+    u32 frames = captureFrameCount();
+    for (u32 frame = 0; frame < frames; frame++) {
+        if (!replaySceneFrame(frame)) {
+            TRACE("capture frame %u is malformed", frame);
+            return false;
+        }
+        cpu_ms += s_replay_timings.cpu_ms[ProfileCpu_Frame];
+        gpu_ms += s_replay_timings.gpu_ms[ProfileGpu_Frame];
+    }
+    TRACE("replaying %u frames, captured at cpu.frame %.3f gpu.frame %.3f ms avg", frames, cpu_ms / frames, gpu_ms / frames);
+    return true;
 }
 
 static void sceneExit() {
-    glDeleteBuffers(1, &s_vbo);
+    hudExit();
+    glDeleteBuffers(1, &s_ibo);
+    glBindBuffer(GL_ARRAY_BUFFER, s_instance_vbo);
+    glUnmapBuffer(GL_ARRAY_BUFFER);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glDeleteBuffers(1, &s_instance_vbo);
+    glUnmapBuffer(GL_DRAW_INDIRECT_BUFFER);
+    glDeleteBuffers(1, &s_indirect_buffer);
+    glDeleteBuffers(1, &s_rank_vbo);
+    glDeleteBuffers(1, &s_color_ssbo);
+    glDeleteBuffers(1, &s_position_vbo);
     glDeleteVertexArrays(1, &s_vao);
+    glDeleteBuffers(1, &s_reveal_ssbo);
+    for (int i = 0; i < FRAME_UNIFORM_SLICES; i++)
+        if (s_frame_ubo_fences[i])
+            glDeleteSync(s_frame_ubo_fences[i]);
+    glBindBuffer(GL_UNIFORM_BUFFER, s_frame_ubo);
+    glUnmapBuffer(GL_UNIFORM_BUFFER);
+    glDeleteBuffers(1, &s_frame_ubo);
+    glDeleteProgram(s_reveal_program);
+    glDeleteProgram(s_wire_program);
+    glDeleteProgram(s_line_program);
     glDeleteProgram(s_program);
 }
 
+#define ALLOC_WARMUP_FRAMES 120
+
+// A profile's clocks, pacing mode and instance budget always change together
+static void setPerfProfile(PerfProfile profile) {
+    perfSetProfile(profile);
+    pacingSetMode(s_display, s_perf_profiles[profile].pacing);
+    s_instance_budget.store(s_perf_profiles[profile].instance_budget, std::memory_order_relaxed);
+}
+
 int main(int argc, char* argv[]) {
     // Set mesa configuration (useful for debugging)
     setMesaConfig();
 
-    // Initialize EGL on the default window
-    if (!initEgl(nwindowGetDefault()))
+    AppConfig config;
+    configLoad(&config, argc, argv);
+    if (config.benchmark) {
+        // Fixed seed so every run reveals vertices in the same order
+        srand(config.benchmark_seed);
+        benchStart(&config);
+        frame_tick = benchFrameTick();
+    }
+    else {
+        frame_tick = armGetSystemTick();
+    }
+    sim_now = frame_tick;
+    reveal_epoch_tick = frame_tick;
+    reveal_duration = config.reveal_duration > REVEAL_DURATION_MIN ? config.reveal_duration : REVEAL_DURATION_MIN;
+    simReset(frame_tick);
+
+    // Initialize EGL on the default window, sized for the current operation mode
+    NWindow* win = nwindowGetDefault();
+    AppletOperationMode operation_mode = appletGetOperationMode();
+    int window_width, window_height;
+    resolutionWindowSize(operation_mode, &window_width, &window_height);
+    nwindowSetDimensions(win, window_width, window_height);
+    if (config.framebuffer < 0 || config.framebuffer >= FramebufferProfile_Count)
+        config.framebuffer = FramebufferProfile_Depth;
+    FramebufferProfile framebuffer_profile = (FramebufferProfile)config.framebuffer;
+    if (!initEgl(win, framebuffer_profile, !config.dynamic_resolution))
         return EXIT_FAILURE;
 
     // Load OpenGL routines using glad
     gladLoadGL();
 
     // Initialize our scene
+    resolutionInit(config.dynamic_resolution, config.min_resolution_scale, window_width, window_height, &s_framebuffer_profiles[framebuffer_profile]);
+    TRACE("framebuffer %s: %.1f MiB at %dx%d", s_framebuffer_profiles[framebuffer_profile].name,
+          framebufferBytes(framebuffer_profile, window_width, window_height) / (1024.0 * 1024.0), window_width, window_height);
+    s_layout_height.store(s_resolution.window_height);
     sceneInit();
+    profilerInit();
+    jobsInit();
+    perfInit();
+    if (config.perf_profile < 0 || config.perf_profile >= PerfProfile_Count)
+        config.perf_profile = PerfProfile_Balanced;
+    setPerfProfile((PerfProfile)config.perf_profile);
+    if (config.benchmark && config.benchmark_pacing >= 0 && config.benchmark_pacing < PacingMode_Count)
+        pacingSetMode(s_display, (PacingMode)config.benchmark_pacing);
+    sphere_lod_override = config.lod;
+    setInstanceCount(config.instances);
 
     // Configure our supported input layout: a single player with standard controller styles
     padConfigureInput(1, HidNpadStyleSet_NpadStandard);
@@ -359,81 +1748,193 @@ int main(int argc, char* argv[]) {
     // Initialize the default gamepad (which reads handheld mode inputs as well as the first connected controller)
     PadState pad;
     padInitializeDefault(&pad);
+    // Separate state for the late sample, so it can't swallow button edges meant for pad
+    PadState late_pad;
+    padInitializeDefault(&late_pad);
+    late_latch = config.late_latch && !config.benchmark;
+    hud_visible = config.hud;
+
+    // The simulation gets a thread of its own and this one only renders its
+    // snapshots. Benchmarks simulate inline, once per frame, so every run
+    // simulates the exact same frames.
+    pipelineInit(&s_snapshot_slots);
+    simFrame(frame_tick, frame_tick, 0, 0, HidAnalogStickState{});
+
+    // A replay renders captured frames instead of simulating, all of them in a
+    // loop or the one given over and over. Frames before that one are restored
+    // first, for the tables it doesn't carry.
+    bool replaying = config.replay && !config.benchmark && replayLoad(CAPTURE_LAYOUT) && replayPrepare();
+    u32 replay_frame = 0;
+    if (replaying && config.replay_frame >= 0) {
+        replay_frame = (u32)config.replay_frame < captureFrameCount() ? config.replay_frame : captureFrameCount() - 1;
+        for (u32 frame = 0; frame < replay_frame; frame++)
+            replaySceneFrame(frame);
+    }
+    if (replaying)
+        late_latch = false;
+    // Captures are live only and opt-in, their buffer and writer are set up ahead of the loop
+    if (config.capture && !config.benchmark && !replaying && config.capture_frames > 0)
+        captureInit(config.capture_frames, CAPTURE_RECORD_MAX);
 
-    // Main graphics loop
-    while (appletMainLoop()) {
-        // Get and process input
-        padUpdate(&pad);
-        u32 buttons_state = padGetButtons(&pad);
+    bool sim_threaded = config.sim_thread && !config.benchmark && !replaying && simThreadStart();
+    TRACE("simulation: %s", replaying ? "replay" : sim_threaded ? "own thread" : "inline");
 
-        if (buttons_state & (HidNpadButton_Left | HidNpadButton_StickLLeft)) {
-            translation_matrix = glm::translate(translation_matrix, glm::vec3(-0.01f, 0.0f, 0.0f));
-            transformation_matrix = glm::rotate(transformation_matrix, glm::radians(-2.3f), glm::vec3(0.0f, 1.0f, 0.0f));
-        }
-        else if (buttons_state & (HidNpadButton_Right | HidNpadButton_StickLRight)) {
-            translation_matrix = glm::translate(translation_matrix, glm::vec3(0.01f, 0.0f, 0.0f));
-            transformation_matrix = glm::rotate(transformation_matrix, glm::radians(2.3f), glm::vec3(0.0f, 1.0f, 0.0f));
-        }
+    // Heap allocations are expected while the first frames warm up the driver, none
+    // of the app's own after; the driver's per-frame fence and swap calls are left out
+    u64 loop_frame = 0;
+    u32 allocations = allocCount();
 
-        //switch to blue
-        if (buttons_state & (HidNpadButton_Up | HidNpadButton_StickLUp)) {
-            selected_color = 2;
-            if (prev_color != selected_color) {
-                is_changing_color = true;
-                changed_indeces.clear();
-            }
-            else is_changing_color = false;
+    // Main graphics loop
+    while (appletMainLoop()) {
+        profilerBeginFrame();
+        arenaReset(&s_frame_arena);
+
+        // Docking or undocking changes the output resolution
+        if (appletGetOperationMode() != operation_mode) {
+            operation_mode = appletGetOperationMode();
+            resolutionWindowSize(operation_mode, &window_width, &window_height);
+            if (!resizeEglWindow(win, window_width, window_height))
+                break;
+            // The swap interval belongs to the surface
+            pacingSetMode(s_display, s_pacing.mode);
+            resolutionSetWindowSize(window_width, window_height);
+            // The simulation picks LODs for the new size on its next frame
+            s_layout_height.store(window_height, std::memory_order_release);
         }
-        else if (buttons_state & (HidNpadButton_Down | HidNpadButton_StickLDown)) {
-            selected_color = 1;
-            if (prev_color != selected_color) {
-                is_changing_color = true;
-                changed_indeces.clear();
-            }
-            else is_changing_color = false;
+        // A replay renders at the captured scale, a benchmark at full scale so runs compare
+        if (!replaying && !config.benchmark)
+            resolutionUpdate(pacingFrameBudgetMs());
+        profilerSetFrameBudget(pacingFrameBudgetMs());
+        perfUpdate();
+
+        const FrameSnapshot* snapshot;
+        if (replaying) {
+            // Only Plus is read from the pad, to leave the replay
+            padUpdate(&pad);
+            if (padGetButtonsDown(&pad) & HidNpadButton_Plus)
+                break;
+            replaySceneFrame(replay_frame);
+            snapshot = &s_replay_snapshot;
+            if (config.replay_frame < 0)
+                replay_frame = (replay_frame + 1) % captureFrameCount();
+            profilerMarkInput(0);
         }
         else {
-            selected_color = 0;
-            if (prev_color != selected_color) {
-                is_changing_color = true;
-                changed_indeces.clear();
+            if (!sim_threaded) {
+                // Get and process input
+                profilerCpuBegin(ProfileCpu_Input);
+                padUpdate(&pad);
+                u64 input_tick = armGetSystemTick();
+                u64 buttons_state, keys_down;
+                HidAnalogStickState stick = {};
+                if (config.benchmark) {
+                    // Only Plus is read from the pad, to abort the run
+                    if (padGetButtonsDown(&pad) & HidNpadButton_Plus)
+                        break;
+                    benchInput(&buttons_state, &keys_down);
+                    frame_tick = benchFrameTick();
+                }
+                else {
+                    buttons_state = padGetButtons(&pad);
+                    keys_down = padGetButtonsDown(&pad);
+                    stick = padGetStickPos(&pad, 0);
+                    frame_tick = armGetSystemTick();
+                }
+                profilerCpuEnd(ProfileCpu_Input);
+
+                simFrame(frame_tick, input_tick, buttons_state, keys_down, stick);
             }
-            else is_changing_color = false;
-        }
 
-        u32 keys_down = padGetButtonsDown(&pad);
-        if (keys_down & HidNpadButton_Minus) {
-            translation_matrix = glm::mat4(1.0f);
-            transformation_matrix = glm::mat4(1.0f);
-        }
-        else if (keys_down & HidNpadButton_Plus) {
-            break;
-        }
+            // Latest snapshot; when none was published since the last frame, the last one is drawn again
+            if (pipelineAcquire(&s_snapshot_slots))
+                profilerCpuSample(ProfileCpu_Sim, s_snapshots[s_snapshot_slots.front].sim_ms);
+            snapshot = &s_snapshots[s_snapshot_slots.front];
+            if (sim_threaded)
+                frame_tick = armGetSystemTick();
 
-        switch(selected_color) {
-            case 0:
-                color = glm::vec3(1.0f, 0.0f, 0.0f);
-                break;
-            case 1:
-                color = glm::vec3(0.0f, 1.0f, 0.0f);
-                break;
-            case 2:
-                color = glm::vec3(0.0f, 0.0f, 1.0f);
-                break;
-            default:
+            u32 requests = sim_requests.exchange(0, std::memory_order_acquire);
+            if (requests & SimRequest_Quit)
                 break;
+            if (requests & SimRequest_CyclePacing)
+                pacingCycleMode(s_display);
+            if (requests & SimRequest_CyclePerf)
+                setPerfProfile((PerfProfile)((s_perf.profile + 1) % PerfProfile_Count));
+            if ((requests & SimRequest_ToggleLateLatch) && !config.benchmark) {
+                late_latch = !late_latch;
+                TRACE("late latch: %s", late_latch ? "on" : "off");
+            }
+            if (requests & SimRequest_ToggleWireframe) {
+                wireframe_mode = wireframe_mode == WireframeMode_SinglePass ? WireframeMode_TwoPass : WireframeMode_SinglePass;
+                sceneUseProgram();
+                TRACE("wireframe mode: %s", wireframe_mode == WireframeMode_SinglePass ? "single pass" : "two pass");
+            }
+            if (requests & SimRequest_Capture)
+                captureStart(config.capture_frames, CAPTURE_LAYOUT);
+            if (requests & SimRequest_ToggleHud) {
+                hud_visible = !hud_visible;
+                hud_refresh_tick = 0;
+                TRACE("hud: %s", hud_visible ? "on" : "off");
+            }
+
+            u64 input_tick = snapshot->input_tick;
+            late_input_valid = late_latch;
+            if (late_latch) {
+                profilerCpuBegin(ProfileCpu_Latch);
+                padUpdate(&late_pad);
+                input_tick = armGetSystemTick();
+                late_input_axis = simInputAxis(padGetButtons(&late_pad), padGetStickPos(&late_pad, 0));
+                // Extrapolate by how far this moment is into the next step
+                frame_tick = input_tick;
+                profilerCpuEnd(ProfileCpu_Latch);
+            }
+            profilerMarkInput(input_tick);
         }
 
         // Render stuff!
-        sceneRender();
+        if (captureActive())
+            captureSceneFrame(snapshot);
+        sceneRender(snapshot);
+        resolutionEndFrame();
+        if (hud_visible)
+            sceneDrawHud(snapshot);
+        sceneEndFrame();
+        profilerEndGpuFrame();
+
+        profilerCpuBegin(ProfileCpu_Pace);
+        pacingWait();
+        profilerCpuEnd(ProfileCpu_Pace);
+
+        profilerCpuBegin(ProfileCpu_Swap);
+        allocPause();
         eglSwapBuffers(s_display, s_surface);
-        prev_color = selected_color;
+        allocResume();
+        profilerCpuEnd(ProfileCpu_Swap);
+
+        u32 allocated = allocCount();
+        if (++loop_frame > ALLOC_WARMUP_FRAMES)
+            profilerCountAllocations(allocated - allocations);
+        allocations = allocated;
+        profilerEndFrame();
+        if (captureActive())
+            captureFrameTimings();
+        capturePoll();
+
+        if (config.benchmark && !benchAdvance()) {
+            benchWriteResults();
+            break;
+        }
     }
 
     // Deinitialize our scene
+    simThreadStop();
+    captureExit();
+    jobsExit();
+    perfExit();
+    profilerExit();
     sceneExit();
+    resolutionExit();
 
     // Deinitialize EGL
     deinitEgl();
     return EXIT_SUCCESS;
-}
\ No newline at end of file
+}